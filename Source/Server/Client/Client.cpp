@@ -222,7 +222,7 @@ void Client::SendAndAwaitWaitForReply(google::protobuf::MessageLite* Request, go
     Frpg2ReliableUdpMessage UntypedResponse;
     SendAndAwaitWaitForReply(Request, UntypedResponse);
 
-    bool Result = Response->ParseFromArray(UntypedResponse.Payload.data(), (int)UntypedResponse.Payload.size());
+    bool Result = Response->ParseFromArray(UntypedResponse.Payload.Data(), (int)UntypedResponse.Payload.Size());
     Ensure(Result);
 }
 
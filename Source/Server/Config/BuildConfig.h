@@ -27,6 +27,13 @@ public:
     // How many seconds without refresh before an authentication ticket expires.
     inline static const double AUTH_TICKET_TIMEOUT = 30.0;
 
+    // Resolution in seconds of the timer wheels used to track timeouts/retransmits/etc.
+    inline static const double TIMER_WHEEL_RESOLUTION = 0.01;
+
+    // Maximum number of compressed payloads kept by the game services payload cache. Only 
+    // messages sent identically to lots of clients go in here, so this can be fairly small.
+    inline static const size_t PAYLOAD_CACHE_MAX_ENTRIES = 32;
+
     // Maximum length of a packet in an Frpg2PacketStream.
     inline static const int MAX_PACKET_LENGTH = 2048;
 
@@ -34,6 +41,45 @@ public:
     // packets beyond this will result in disconnect.
     inline static const int MAX_SEND_QUEUE_SIZE = 256 * 1024;
 
+    // Maximum size of a single datagram we can recieve on a udp connection.
+    inline static const int UDP_MAX_DATAGRAM_SIZE = 64 * 1024;
+
+    // Space reserved at the front of packet buffers so every layer of the reliable udp
+    // stack (message, fragment, packet and cipher headers) can prepend its header in place.
+    inline static const size_t PACKET_BUFFER_HEADROOM = 128;
+
+    // How many datagrams a listening udp connection will try to recieve in 
+    // a single syscall when batched io is enabled.
+    inline static const int UDP_RECIEVE_BATCH_SIZE = 32;
+
+    // Upper bound on how many datagrams are drained from a udp socket in a single
+    // pump, stops a flood starving the rest of the server.
+    inline static const int UDP_MAX_DATAGRAMS_PER_PUMP = 1024;
+
+    // How many datagrams a second (and how many in a burst) a single ip address can send to a 
+    // listening udp connection from ports that don't have a connection yet. Stops a single host
+    // making us do lots of work (or allocate lots of connections) with junk or spoofed datagrams.
+    inline static const double UDP_NEW_PEER_DATAGRAMS_PER_SECOND = 10.0;
+    inline static const double UDP_NEW_PEER_DATAGRAM_BURST = 20.0;
+
+    // Maximum number of ip addresses the above rate limit tracks at once. Datagrams from 
+    // untracked addresses are dropped while the table is full.
+    inline static const size_t UDP_MAX_RATE_LIMITED_ADDRESSES = 64 * 1024;
+
+    // Maximum number of datagrams child connections can queue on a batched udp listener
+    // between flushes. Datagrams sent while the queue is full are dropped, the reliable
+    // layer will retransmit them.
+    inline static const size_t UDP_MAX_PENDING_SEND_BATCH = 4096;
+
+    // Maximum number of destroyed child connections that are removed from a 
+    // listening udp connections routing table each pump.
+    inline static const int UDP_CHILD_RECLAIM_BATCH_SIZE = 64;
+
+    // Longest the server will sleep for (in seconds) when a service has nothing scheduled,
+    // if none of its sockets recieve data in the meantime. Services with clients wake up 
+    // for their clients next timeout/retransmit/etc rather than polling at a fixed rate.
+    inline static const double SERVICE_IDLE_POLL_INTERVAL = 1.0;
+
     // What application version we support (this is the app version shown on the menu without the dot and -1).
     // So 1.15 = 114
     inline static const int APP_VERSION = 114;
@@ -61,6 +107,10 @@ public:
     // How many seconds of inactivity before a webui authentication token expires.
     inline static const double WEBUI_AUTH_TIMEOUT = 60.0 * 60.0;
 
+    // Maximum number of unused protobuf instances of each type kept per thread for reuse
+    // by recieved messages. See Frpg2ProtobufPool.
+    inline static const size_t PROTOBUF_POOL_MAX_FREE_PER_TYPE = 16;
+
     // If enabled we will store per-player stats in the database. Be warned this bloats the DB a -lot-
     // if we have many players.
     inline static const bool STORE_PER_PLAYER_STATISTICS = false;
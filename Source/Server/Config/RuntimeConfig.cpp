@@ -224,7 +224,12 @@ bool RuntimeConfig::Serialize(nlohmann::json& Json, bool Loading)
 
     SERIALIZE_VAR(LoginServerPort);
     SERIALIZE_VAR(AuthServerPort);
+    SERIALIZE_VAR(AuthServerWorkerCount);
+    SERIALIZE_VAR(AuthServerSkipSteamValidation);
     SERIALIZE_VAR(GameServerPort);
+    SERIALIZE_VAR(GameServerBatchedIO);
+    SERIALIZE_VAR(GameServerShardCount);
+    SERIALIZE_VAR(GameServerAckDelay);
     SERIALIZE_VAR(WebUIServerPort);
     SERIALIZE_VAR(WebUIServerUsername);
     SERIALIZE_VAR(WebUIServerPassword);
@@ -110,9 +110,34 @@ public:
     // Network port the authentication server listens for connections on.
     int AuthServerPort = 50000;
 
+    // How many threads the authentication server uses for the expensive part of
+    // the handshake (rsa decryption), so a flood of clients reconnecting doesn't 
+    // stall the rest of the server.
+    int AuthServerWorkerCount = 2;
+
+    // If true steam tickets are accepted without being validated with steam. Only
+    // intended for local testing, never enable this on a public server.
+    bool AuthServerSkipSteamValidation = false;
+
     // Network port the game server listens for connections on.
     int GameServerPort = 50010;
 
+    // If true the game server drains its socket in batches each frame and 
+    // sends all outgoing datagrams together at the end of the frame, rather
+    // than a single syscall per datagram.
+    bool GameServerBatchedIO = true;
+
+    // How many threads the game server spreads its clients across. Each thread
+    // gets its own SO_REUSEPORT socket on GameServerPort. This is linux only,
+    // on other platforms (including windows) values above 1 are ignored.
+    int GameServerShardCount = 1;
+
+    // How long (in seconds) the game server holds on to acknowledgements of client
+    // packets, in the hope of sending them along with a reply rather than in a 
+    // datagram of their own. 0 sends acknowledgements immediately, which is what 
+    // the retail server does.
+    double GameServerAckDelay = 0.0;
+
     // Network port the admin web-ui server listens for connections on.
     int WebUIServerPort = 50005;
 
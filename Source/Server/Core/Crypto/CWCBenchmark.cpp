@@ -0,0 +1,142 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Crypto/CWCBenchmark.h"
+#include "Core/Crypto/CWCContext.h"
+
+#include "Core/Utils/Logging.h"
+#include "Core/Utils/Random.h"
+
+#include <vector>
+#include <chrono>
+#include <cstring>
+
+namespace 
+{
+    // Encrypts random messages of different lengths with both implementations and 
+    // makes sure the ciphertext and tags match, and that each can decrypt the others output.
+    bool VerifyImplementationsMatch(CWCContext& Portable, CWCContext& Accelerated)
+    {
+        const size_t VerifyIterations = 2000;
+
+        std::vector<uint8_t> IV(CWCContext::IV_SIZE);
+        std::vector<uint8_t> Header(32);
+        std::vector<uint8_t> Message;
+
+        for (size_t i = 0; i < VerifyIterations; i++)
+        {
+            size_t HeaderLength = i % Header.size();
+            size_t MessageLength = i;
+
+            FillRandomBytes(IV);
+            FillRandomBytes(Header);
+            Message.resize(MessageLength);
+            FillRandomBytes(Message);
+
+            std::vector<uint8_t> PortableOutput = Message;
+            std::vector<uint8_t> AcceleratedOutput = Message;
+            uint8_t PortableTag[CWCContext::TAG_SIZE];
+            uint8_t AcceleratedTag[CWCContext::TAG_SIZE];
+
+            if (!Portable.Encrypt(IV.data(), Header.data(), HeaderLength, PortableOutput.data(), MessageLength, PortableTag) ||
+                !Accelerated.Encrypt(IV.data(), Header.data(), HeaderLength, AcceleratedOutput.data(), MessageLength, AcceleratedTag))
+            {
+                Error("Failed to encrypt %zi byte message.", MessageLength);
+                return false;
+            }
+
+            if (PortableOutput != AcceleratedOutput || memcmp(PortableTag, AcceleratedTag, CWCContext::TAG_SIZE) != 0)
+            {
+                Error("Output of implementations differs for %zi byte message with %zi byte header.", MessageLength, HeaderLength);
+                return false;
+            }
+
+            if (!Accelerated.Decrypt(IV.data(), Header.data(), HeaderLength, PortableOutput.data(), MessageLength, PortableTag) ||
+                !Portable.Decrypt(IV.data(), Header.data(), HeaderLength, AcceleratedOutput.data(), MessageLength, AcceleratedTag) ||
+                PortableOutput != Message ||
+                AcceleratedOutput != Message)
+            {
+                Error("Failed to decrypt %zi byte message.", MessageLength);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Returns throughput in megabytes per second of encrypting messages of the given length.
+    double MeasureThroughput(CWCContext& Context, size_t MessageLength)
+    {
+        const size_t TargetBytes = 256 * 1024 * 1024;
+        const size_t Iterations = TargetBytes / MessageLength;
+
+        std::vector<uint8_t> IV(CWCContext::IV_SIZE);
+        std::vector<uint8_t> Header(CWCContext::IV_SIZE);
+        std::vector<uint8_t> Message(MessageLength);
+        uint8_t Tag[CWCContext::TAG_SIZE];
+
+        FillRandomBytes(IV);
+        FillRandomBytes(Header);
+        FillRandomBytes(Message);
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < Iterations; i++)
+        {
+            Context.Encrypt(IV.data(), Header.data(), Header.size(), Message.data(), Message.size(), Tag);
+        }
+
+        auto EndTime = std::chrono::high_resolution_clock::now();
+        double Elapsed = std::chrono::duration<double>(EndTime - StartTime).count();
+
+        return (Iterations * MessageLength) / (1024.0 * 1024.0) / Elapsed;
+    }
+};
+
+bool RunCWCBenchmark()
+{
+    std::vector<uint8_t> Key(16);
+    FillRandomBytes(Key);
+
+    CWCContext Portable(false);
+    CWCContext Accelerated(true);
+    if (!Portable.Init(Key.data(), Key.size()) || 
+        !Accelerated.Init(Key.data(), Key.size()))
+    {
+        Error("Failed to initialize cwc contexts.");
+        return false;
+    }
+
+    if (!Accelerated.IsAccelerated())
+    {
+        Warning("CPU does not support AES-NI, only the portable implementation is available.");
+    }
+    else if (!VerifyImplementationsMatch(Portable, Accelerated))
+    {
+        return false;
+    }
+    else
+    {
+        Success("Accelerated and portable implementations produce identical output.");
+    }
+
+    // Roughly the sizes we see in practice, from acks up to a full mtu.
+    const size_t MessageLengths[] = { 16, 64, 256, 512, 1024, 1400 };
+
+    Log("%10s %20s %20s %10s", "Size", "Portable (MB/s)", "Accelerated (MB/s)", "Speedup");
+    for (size_t MessageLength : MessageLengths)
+    {
+        double PortableThroughput = MeasureThroughput(Portable, MessageLength);
+        double AcceleratedThroughput = MeasureThroughput(Accelerated, MessageLength);
+
+        Log("%10zi %20.1f %20.1f %9.2fx", MessageLength, PortableThroughput, AcceleratedThroughput, AcceleratedThroughput / PortableThroughput);
+    }
+
+    return true;
+}
@@ -0,0 +1,18 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+// Checks that the accelerated CWC implementation produces the same output as 
+// the portable one, then measures the throughput of both for a range of 
+// typical packet sizes and logs the results. 
+//
+// Run with -benchmark_cwc on the command line. Returns false if the outputs
+// of the two implementations differ.
+bool RunCWCBenchmark();
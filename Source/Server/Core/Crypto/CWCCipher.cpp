@@ -14,52 +14,72 @@
 #include "Core/Utils/Endian.h"
 #include "Core/Utils/Strings.h"
 
+#include <cstring>
+
 CWCCipher::CWCCipher(const std::vector<uint8_t>& InKey)
     : Key(InKey)
 {
-    cwc_init_and_key(InKey.data(), (unsigned long)InKey.size(), &CwcContext);
+    CwcContext.Init(InKey.data(), InKey.size());
 }
 
 bool CWCCipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
 {
-    std::vector<uint8_t> IV(11, 0);
-    std::vector<uint8_t> Tag(16, 0);
-    std::vector<uint8_t> Payload = Input;
+    Output.resize(HEADER_SIZE + Input.size());
+    if (Input.size() > 0)
+    {
+        memcpy(Output.data() + HEADER_SIZE, Input.data(), Input.size());
+    }
 
-    FillRandomBytes(IV);
+    return EncryptInPlace(Output.data(), Output.size());
+}
 
-    if (cwc_encrypt_message(IV.data(), 11, IV.data(), 11, (unsigned char*)Payload.data(), (unsigned long)Payload.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+bool CWCCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+{
+    Output = Input;
+    if (!DecryptInPlace(Output.data(), Output.size()))
     {
         return false;
     }
 
-    Output.resize(Payload.size() + 11 + 16);
+    Output.erase(Output.begin(), Output.begin() + HEADER_SIZE);
 
-    memcpy(Output.data(), IV.data(), 11);
-    memcpy(Output.data() + 11, Tag.data(), 16);
-    memcpy(Output.data() + 11 + 16, Payload.data(), Payload.size());
+    return true;
+}
+
+bool CWCCipher::EncryptInPlace(uint8_t* Buffer, size_t Size)
+{
+    if (Size < HEADER_SIZE)
+    {
+        return false;
+    }
+
+    uint8_t* IV = Buffer;
+    uint8_t* Tag = Buffer + 11;
+    uint8_t* Payload = Buffer + 11 + 16;
+
+    FillRandomBytes(IV, 11);
+
+    if (!CwcContext.Encrypt(IV, IV, 11, Payload, Size - HEADER_SIZE, Tag))
+    {
+        return false;
+    }
 
     return true;
 }
 
-bool CWCCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCCipher::DecryptInPlace(uint8_t* Buffer, size_t Size)
 {
-    std::vector<uint8_t> IV(11);
-    std::vector<uint8_t> Tag(16);
-    
     // Actually enough data for any data?
-    if (Input.size() < 11 + 16 + 1)
+    if (Size < HEADER_SIZE + 1)
     {
         return false;
     }
 
-    Output.resize(Input.size() - 11 - 16);
-
-    memcpy(IV.data(), Input.data(), 11);
-    memcpy(Tag.data(), Input.data() + 11, 16);
-    memcpy(Output.data(), Input.data() + 11 + 16, Output.size());
+    uint8_t* IV = Buffer;
+    uint8_t* Tag = Buffer + 11;
+    uint8_t* Payload = Buffer + 11 + 16;
 
-    if (cwc_decrypt_message(IV.data(), 11, IV.data(), 11, (unsigned char*)Output.data(), (unsigned long)Output.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (!CwcContext.Decrypt(IV, IV, 11, Payload, Size - HEADER_SIZE, Tag))
     {
         return false;
     }
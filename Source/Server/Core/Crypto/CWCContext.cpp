@@ -0,0 +1,458 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Crypto/CWCContext.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CWC_AESNI_SUPPORTED 1
+#else
+#define CWC_AESNI_SUPPORTED 0
+#endif
+
+#if CWC_AESNI_SUPPORTED
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// msvc lets us use any intrinsic anywhere, gcc/clang need to be told which 
+// functions are allowed to use the AES instructions.
+#if defined(__GNUC__)
+#define CWC_TARGET_AESNI __attribute__((target("aes,sse2")))
+#else
+#define CWC_TARGET_AESNI
+#endif
+
+namespace 
+{
+#if CWC_AESNI_SUPPORTED
+
+    bool DetectAesNi()
+    {
+#if defined(_MSC_VER)
+        int Info[4];
+        __cpuid(Info, 1);
+        return (Info[2] & (1 << 25)) != 0;
+#else
+        unsigned int Eax, Ebx, Ecx, Edx;
+        if (!__get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx))
+        {
+            return false;
+        }
+        return (Ecx & bit_AES) != 0;
+#endif
+    }
+
+    // 128 bit integers as hi/lo pairs, all arithmetic wraps modulo 2^128.
+    struct Uint128
+    {
+        uint64_t Hi;
+        uint64_t Lo;
+    };
+
+    inline Uint128 Add(Uint128 A, Uint128 B)
+    {
+        Uint128 Result;
+        Result.Lo = A.Lo + B.Lo;
+        Result.Hi = A.Hi + B.Hi + (Result.Lo < A.Lo ? 1 : 0);
+        return Result;
+    }
+
+    inline Uint128 Multiply64(uint64_t A, uint64_t B)
+    {
+        Uint128 Result;
+#if defined(_MSC_VER)
+        Result.Lo = _umul128(A, B, &Result.Hi);
+#else
+        unsigned __int128 Product = (unsigned __int128)A * B;
+        Result.Lo = (uint64_t)Product;
+        Result.Hi = (uint64_t)(Product >> 64);
+#endif
+        return Result;
+    }
+
+    // Full 256 bit product of two 128 bit values.
+    inline void Multiply128(Uint128 A, Uint128 B, Uint128& ProductHi, Uint128& ProductLo)
+    {
+        Uint128 LL = Multiply64(A.Lo, B.Lo);
+        Uint128 LH = Multiply64(A.Lo, B.Hi);
+        Uint128 HL = Multiply64(A.Hi, B.Lo);
+        Uint128 HH = Multiply64(A.Hi, B.Hi);
+
+        // Sum the middle terms into bits 64-191.
+        Uint128 Middle = Add(LH, HL);
+        uint64_t MiddleCarry = (Middle.Hi < LH.Hi || (Middle.Hi == LH.Hi && Middle.Lo < LH.Lo)) ? 1 : 0;
+
+        ProductLo.Lo = LL.Lo;
+        ProductLo.Hi = LL.Hi + Middle.Lo;
+        uint64_t Carry = (ProductLo.Hi < LL.Hi) ? 1 : 0;
+
+        ProductHi = Add(HH, Uint128{ MiddleCarry, Middle.Hi });
+        ProductHi = Add(ProductHi, Uint128{ 0, Carry });
+    }
+
+    inline uint32_t LoadLittleEndian32(const uint8_t* Data)
+    {
+        return (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+    }
+
+    inline uint64_t LoadBigEndian64(const uint8_t* Data)
+    {
+        uint64_t Result = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            Result = (Result << 8) | Data[i];
+        }
+        return Result;
+    }
+
+    inline void StoreBigEndian64(uint8_t* Data, uint64_t Value)
+    {
+        for (int i = 7; i >= 0; i--)
+        {
+            Data[i] = (uint8_t)Value;
+            Value >>= 8;
+        }
+    }
+
+    inline uint32_t ByteSwap32(uint32_t Value)
+    {
+        return (Value >> 24) | ((Value >> 8) & 0xFF00) | ((Value << 8) & 0xFF0000) | (Value << 24);
+    }
+
+    const uint64_t TOP_BIT = 0x8000000000000000ull;
+
+    // The universal hash, this is a straight port of do_cwc from cwc.c's 
+    // USE_LONGS path (which is what the portable version is built with). It
+    // has to match it exactly rather than being a "proper" reduction mod 
+    // 2^127-1, as the two can differ in the final bits of the result.
+    class CwcHash
+    {
+    public:
+        CwcHash(Uint128 InKey)
+            : Key(InKey)
+        {
+        }
+
+        void AddBytes(const uint8_t* Data, size_t Length)
+        {
+            while (Length >= BLOCK_SIZE)
+            {
+                AddBlock(Data);
+                Data += BLOCK_SIZE;
+                Length -= BLOCK_SIZE;
+            }
+
+            // The last partial block of each section is zero padded.
+            if (Length > 0)
+            {
+                uint8_t Padded[BLOCK_SIZE] = {};
+                memcpy(Padded, Data, Length);
+                AddBlock(Padded);
+            }
+        }
+
+        Uint128 Finish(uint32_t HeaderLength, uint32_t MessageLength)
+        {
+            Uint128 Result = Add(Value, Uint128{ HeaderLength, MessageLength });
+            if (Result.Hi & TOP_BIT)
+            {
+                Result.Hi &= ~TOP_BIT;
+                Result = Add(Result, Uint128{ 0, 1 });
+            }
+            return Result;
+        }
+
+    private:
+        void AddBlock(const uint8_t* Data)
+        {
+            // Blocks are 96 bits, read as 3 native (little endian) words with the
+            // first being the most significant.
+            Uint128 Block;
+            Block.Hi = LoadLittleEndian32(Data);
+            Block.Lo = ((uint64_t)LoadLittleEndian32(Data + 4) << 32) | LoadLittleEndian32(Data + 8);
+
+            Uint128 ProductHi, ProductLo;
+            Multiply128(Add(Block, Value), Key, ProductHi, ProductLo);
+
+            // ProductHi * 2^128 = ProductHi * 2 * 2^127, fold it down.
+            Uint128 Folded = Add(ProductHi, ProductHi);
+            if (ProductLo.Hi & TOP_BIT)
+            {
+                ProductLo.Hi &= ~TOP_BIT;
+                Folded.Lo += 1;
+            }
+
+            Value = Add(Folded, ProductLo);
+            if (Value.Hi & TOP_BIT)
+            {
+                Value.Hi &= ~TOP_BIT;
+                Value = Add(Value, Uint128{ 0, 1 });
+            }
+        }
+
+    private:
+        static inline const size_t BLOCK_SIZE = 12;
+
+        Uint128 Key;
+        Uint128 Value = { 0, 0 };
+
+    };
+
+    template <int Rcon>
+    CWC_TARGET_AESNI inline __m128i ExpandKeyStep(__m128i Key)
+    {
+        __m128i Generated = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(Key, Rcon), 0xFF);
+        Key = _mm_xor_si128(Key, _mm_slli_si128(Key, 4));
+        Key = _mm_xor_si128(Key, _mm_slli_si128(Key, 4));
+        Key = _mm_xor_si128(Key, _mm_slli_si128(Key, 4));
+        return _mm_xor_si128(Key, Generated);
+    }
+
+    CWC_TARGET_AESNI void ExpandKey128(const uint8_t* Key, uint8_t* RoundKeyBytes)
+    {
+        __m128i* RoundKeys = reinterpret_cast<__m128i*>(RoundKeyBytes);
+        RoundKeys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Key));
+        RoundKeys[1] = ExpandKeyStep<0x01>(RoundKeys[0]);
+        RoundKeys[2] = ExpandKeyStep<0x02>(RoundKeys[1]);
+        RoundKeys[3] = ExpandKeyStep<0x04>(RoundKeys[2]);
+        RoundKeys[4] = ExpandKeyStep<0x08>(RoundKeys[3]);
+        RoundKeys[5] = ExpandKeyStep<0x10>(RoundKeys[4]);
+        RoundKeys[6] = ExpandKeyStep<0x20>(RoundKeys[5]);
+        RoundKeys[7] = ExpandKeyStep<0x40>(RoundKeys[6]);
+        RoundKeys[8] = ExpandKeyStep<0x80>(RoundKeys[7]);
+        RoundKeys[9] = ExpandKeyStep<0x1B>(RoundKeys[8]);
+        RoundKeys[10] = ExpandKeyStep<0x36>(RoundKeys[9]);
+    }
+
+    CWC_TARGET_AESNI inline __m128i EncryptBlock(const __m128i* RoundKeys, __m128i Block)
+    {
+        Block = _mm_xor_si128(Block, RoundKeys[0]);
+        for (int i = 1; i < 10; i++)
+        {
+            Block = _mm_aesenc_si128(Block, RoundKeys[i]);
+        }
+        return _mm_aesenclast_si128(Block, RoundKeys[10]);
+    }
+
+    // Encrypts 4 blocks at once so the aesenc's can be pipelined.
+    CWC_TARGET_AESNI inline void EncryptBlocks4(const __m128i* RoundKeys, __m128i& B0, __m128i& B1, __m128i& B2, __m128i& B3)
+    {
+        B0 = _mm_xor_si128(B0, RoundKeys[0]);
+        B1 = _mm_xor_si128(B1, RoundKeys[0]);
+        B2 = _mm_xor_si128(B2, RoundKeys[0]);
+        B3 = _mm_xor_si128(B3, RoundKeys[0]);
+        for (int i = 1; i < 10; i++)
+        {
+            B0 = _mm_aesenc_si128(B0, RoundKeys[i]);
+            B1 = _mm_aesenc_si128(B1, RoundKeys[i]);
+            B2 = _mm_aesenc_si128(B2, RoundKeys[i]);
+            B3 = _mm_aesenc_si128(B3, RoundKeys[i]);
+        }
+        B0 = _mm_aesenclast_si128(B0, RoundKeys[10]);
+        B1 = _mm_aesenclast_si128(B1, RoundKeys[10]);
+        B2 = _mm_aesenclast_si128(B2, RoundKeys[10]);
+        B3 = _mm_aesenclast_si128(B3, RoundKeys[10]);
+    }
+
+    // Counter blocks are 0x80, the 11 byte IV, then a 32 bit big endian counter.
+    CWC_TARGET_AESNI inline __m128i MakeCounterBlock(__m128i Base, uint32_t Counter)
+    {
+        return _mm_or_si128(Base, _mm_set_epi32((int)ByteSwap32(Counter), 0, 0, 0));
+    }
+
+    CWC_TARGET_AESNI __m128i MakeCounterBase(const uint8_t* IV)
+    {
+        uint8_t Bytes[16] = {};
+        Bytes[0] = 0x80;
+        memcpy(Bytes + 1, IV, CWCContext::IV_SIZE);
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Bytes));
+    }
+
+    // XORs the message with the keystream, data uses counters starting at 1.
+    CWC_TARGET_AESNI void CryptCounterMode(const uint8_t* RoundKeyBytes, __m128i Base, uint8_t* Data, size_t Length)
+    {
+        const __m128i* RoundKeys = reinterpret_cast<const __m128i*>(RoundKeyBytes);
+        uint32_t Counter = 1;
+
+        while (Length >= 64)
+        {
+            __m128i B0 = MakeCounterBlock(Base, Counter);
+            __m128i B1 = MakeCounterBlock(Base, Counter + 1);
+            __m128i B2 = MakeCounterBlock(Base, Counter + 2);
+            __m128i B3 = MakeCounterBlock(Base, Counter + 3);
+            Counter += 4;
+
+            EncryptBlocks4(RoundKeys, B0, B1, B2, B3);
+
+            __m128i* Blocks = reinterpret_cast<__m128i*>(Data);
+            _mm_storeu_si128(Blocks + 0, _mm_xor_si128(_mm_loadu_si128(Blocks + 0), B0));
+            _mm_storeu_si128(Blocks + 1, _mm_xor_si128(_mm_loadu_si128(Blocks + 1), B1));
+            _mm_storeu_si128(Blocks + 2, _mm_xor_si128(_mm_loadu_si128(Blocks + 2), B2));
+            _mm_storeu_si128(Blocks + 3, _mm_xor_si128(_mm_loadu_si128(Blocks + 3), B3));
+
+            Data += 64;
+            Length -= 64;
+        }
+
+        while (Length >= 16)
+        {
+            __m128i Keystream = EncryptBlock(RoundKeys, MakeCounterBlock(Base, Counter++));
+
+            __m128i* Block = reinterpret_cast<__m128i*>(Data);
+            _mm_storeu_si128(Block, _mm_xor_si128(_mm_loadu_si128(Block), Keystream));
+
+            Data += 16;
+            Length -= 16;
+        }
+
+        if (Length > 0)
+        {
+            alignas(16) uint8_t Keystream[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(Keystream), EncryptBlock(RoundKeys, MakeCounterBlock(Base, Counter)));
+
+            for (size_t i = 0; i < Length; i++)
+            {
+                Data[i] ^= Keystream[i];
+            }
+        }
+    }
+
+    // Encrypts the final hash value with the key and masks it with the counter 0 keystream block.
+    CWC_TARGET_AESNI void ComputeTag(const uint8_t* RoundKeyBytes, __m128i Base, Uint128 Hash, uint8_t* Tag)
+    {
+        const __m128i* RoundKeys = reinterpret_cast<const __m128i*>(RoundKeyBytes);
+
+        uint8_t HashBytes[16];
+        StoreBigEndian64(HashBytes, Hash.Hi);
+        StoreBigEndian64(HashBytes + 8, Hash.Lo);
+
+        __m128i HashBlock = EncryptBlock(RoundKeys, _mm_loadu_si128(reinterpret_cast<const __m128i*>(HashBytes)));
+        __m128i Mask = EncryptBlock(RoundKeys, MakeCounterBlock(Base, 0));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Tag), _mm_xor_si128(HashBlock, Mask));
+    }
+
+    CWC_TARGET_AESNI Uint128 ComputeHashKey(const uint8_t* RoundKeyBytes)
+    {
+        const __m128i* RoundKeys = reinterpret_cast<const __m128i*>(RoundKeyBytes);
+
+        alignas(16) uint8_t Bytes[16] = {};
+        Bytes[0] = 0xC0;
+        _mm_store_si128(reinterpret_cast<__m128i*>(Bytes), EncryptBlock(RoundKeys, _mm_load_si128(reinterpret_cast<const __m128i*>(Bytes))));
+        Bytes[0] &= 0x7F;
+
+        return Uint128{ LoadBigEndian64(Bytes), LoadBigEndian64(Bytes + 8) };
+    }
+
+    const bool bAesNiSupported = DetectAesNi();
+
+#else
+
+    const bool bAesNiSupported = false;
+
+#endif
+};
+
+CWCContext::CWCContext(bool AllowAcceleration)
+    : bAllowAcceleration(AllowAcceleration)
+{
+    memset(&PortableContext, 0, sizeof(PortableContext));
+    memset(RoundKeys, 0, sizeof(RoundKeys));
+}
+
+CWCContext::~CWCContext()
+{
+    cwc_end(&PortableContext);
+    memset(RoundKeys, 0, sizeof(RoundKeys));
+}
+
+bool CWCContext::IsAccelerationSupported()
+{
+    return bAesNiSupported;
+}
+
+bool CWCContext::Init(const uint8_t* Key, size_t KeyLength)
+{
+    // We always set up the portable context, it handles key sizes the 
+    // accelerated version doesn't.
+    if (cwc_init_and_key(Key, (unsigned long)KeyLength, &PortableContext) == RETURN_ERROR)
+    {
+        return false;
+    }
+
+    bAccelerated = false;
+
+#if CWC_AESNI_SUPPORTED
+    if (bAllowAcceleration && bAesNiSupported && KeyLength == 16)
+    {
+        ExpandKey128(Key, RoundKeys);
+
+        Uint128 HashKey = ComputeHashKey(RoundKeys);
+        HashKeyHi = HashKey.Hi;
+        HashKeyLo = HashKey.Lo;
+
+        bAccelerated = true;
+    }
+#endif
+
+    return true;
+}
+
+bool CWCContext::Encrypt(const uint8_t* IV, const uint8_t* Header, size_t HeaderLength, uint8_t* Message, size_t MessageLength, uint8_t* Tag)
+{
+#if CWC_AESNI_SUPPORTED
+    if (bAccelerated)
+    {
+        __m128i Base = MakeCounterBase(IV);
+
+        CryptCounterMode(RoundKeys, Base, Message, MessageLength);
+
+        CwcHash Hash({ HashKeyHi, HashKeyLo });
+        Hash.AddBytes(Header, HeaderLength);
+        Hash.AddBytes(Message, MessageLength);
+
+        ComputeTag(RoundKeys, Base, Hash.Finish((uint32_t)HeaderLength, (uint32_t)MessageLength), Tag);
+        return true;
+    }
+#endif
+
+    return cwc_encrypt_message(IV, (unsigned long)IV_SIZE, Header, (unsigned long)HeaderLength, Message, (unsigned long)MessageLength, Tag, (unsigned long)TAG_SIZE, &PortableContext) != RETURN_ERROR;
+}
+
+bool CWCContext::Decrypt(const uint8_t* IV, const uint8_t* Header, size_t HeaderLength, uint8_t* Message, size_t MessageLength, const uint8_t* Tag)
+{
+#if CWC_AESNI_SUPPORTED
+    if (bAccelerated)
+    {
+        __m128i Base = MakeCounterBase(IV);
+
+        CwcHash Hash({ HashKeyHi, HashKeyLo });
+        Hash.AddBytes(Header, HeaderLength);
+        Hash.AddBytes(Message, MessageLength);
+
+        uint8_t ExpectedTag[TAG_SIZE];
+        ComputeTag(RoundKeys, Base, Hash.Finish((uint32_t)HeaderLength, (uint32_t)MessageLength), ExpectedTag);
+
+        // Same as the portable version, the message is decrypted even if the tag 
+        // doesn't match, callers are expected to throw it away.
+        CryptCounterMode(RoundKeys, Base, Message, MessageLength);
+
+        return memcmp(ExpectedTag, Tag, TAG_SIZE) == 0;
+    }
+#endif
+
+    return cwc_decrypt_message(IV, (unsigned long)IV_SIZE, Header, (unsigned long)HeaderLength, Message, (unsigned long)MessageLength, Tag, (unsigned long)TAG_SIZE, &PortableContext) != RETURN_ERROR;
+}
@@ -0,0 +1,68 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "cwc.h"
+
+#include <cstdint>
+#include <cstddef>
+
+// Encrypts and authenticates whole messages using AES in CWC mode, this is what
+// the game uses to encrypt most of its traffic.
+//
+// The portable implementation in ThirdParty/aes_modes uses table based AES and 
+// does the universal hash 32 bits at a time, which makes it one of the larger 
+// per-packet costs. When the cpu supports AES-NI (checked once at startup) and 
+// a 128 bit key is used, this uses an implementation built on the AES-NI 
+// instructions and 64 bit multiplies instead. Its output is bit-exact with the 
+// portable version, the client doesn't know or care which one we used.
+//
+// CWC's hash works modulo 2^127-1 rather than in GF(2^128) like GCM, so carry-less 
+// multiply isn't any help here, plain integer multiplies are what it needs.
+
+class CWCContext
+{
+public:
+    static inline const size_t IV_SIZE = 11;
+    static inline const size_t TAG_SIZE = 16;
+
+public:
+    // AllowAcceleration can be set to false to always use the portable 
+    // implementation, mostly useful for comparing the two.
+    CWCContext(bool AllowAcceleration = true);
+    ~CWCContext();
+
+    bool Init(const uint8_t* Key, size_t KeyLength);
+
+    // Encrypts the message in place and writes the authentication tag for it and the header.
+    bool Encrypt(const uint8_t* IV, const uint8_t* Header, size_t HeaderLength, uint8_t* Message, size_t MessageLength, uint8_t* Tag);
+
+    // Decrypts the message in place, returns false if the tag doesn't match.
+    bool Decrypt(const uint8_t* IV, const uint8_t* Header, size_t HeaderLength, uint8_t* Message, size_t MessageLength, const uint8_t* Tag);
+
+    // True if this context is using the AES-NI implementation.
+    bool IsAccelerated() const { return bAccelerated; }
+
+    // True if the cpu we are running on supports the AES-NI implementation.
+    static bool IsAccelerationSupported();
+
+private:
+    bool bAllowAcceleration;
+    bool bAccelerated = false;
+
+    cwc_ctx PortableContext;
+
+    // State for the accelerated implementation, the expanded AES-128 key 
+    // and the hash key.
+    alignas(16) uint8_t RoundKeys[11 * 16];
+    uint64_t HashKeyHi = 0;
+    uint64_t HashKeyLo = 0;
+
+};
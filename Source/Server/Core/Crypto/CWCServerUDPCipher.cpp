@@ -14,13 +14,15 @@
 #include "Core/Utils/Endian.h"
 #include "Core/Utils/Strings.h"
 
+#include <cstring>
+
 // Basically the same as CWCCipher except for different header verification.
 
 CWCServerUDPCipher::CWCServerUDPCipher(const std::vector<uint8_t>& InKey, uint64_t InAuthToken)
     : Key(InKey)
     , AuthToken(InAuthToken)
 {
-    cwc_init_and_key(InKey.data(), (unsigned long)InKey.size(), &CwcContext);
+    CwcContext.Init(InKey.data(), InKey.size());
 
     // Auth token bytes to encode in the header are the reversed auth token.
     uint8_t* InAuthTokenBytes = reinterpret_cast<uint8_t*>(&InAuthToken);
@@ -29,56 +31,63 @@ CWCServerUDPCipher::CWCServerUDPCipher(const std::vector<uint8_t>& InKey, uint64
 
 bool CWCServerUDPCipher::Encrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
 {
-    std::vector<uint8_t> IV(11, 0);
-    std::vector<uint8_t> Tag(16, 0);
-    std::vector<uint8_t> Payload = Input;
+    Output.resize(HEADER_SIZE + Input.size());
+    if (Input.size() > 0)
+    {
+        memcpy(Output.data() + HEADER_SIZE, Input.data(), Input.size());
+    }
+
+    return EncryptInPlace(Output.data(), Output.size());
+}
+
+bool CWCServerUDPCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+{
+    Output = Input;
+    if (!DecryptInPlace(Output.data(), Output.size()))
+    {
+        return false;
+    }
 
-    FillRandomBytes(IV);
+    Output.erase(Output.begin(), Output.begin() + HEADER_SIZE);
 
-    std::vector<uint8_t> Header;
-    Header.resize(11);
-    memcpy(Header.data(), IV.data(), 11);
+    return true;
+}
 
-    if (cwc_encrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Payload.data(), (unsigned long)Payload.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+bool CWCServerUDPCipher::EncryptInPlace(uint8_t* Buffer, size_t Size)
+{
+    if (Size < HEADER_SIZE)
     {
         return false;
     }
 
-    Output.resize(Payload.size() + 11 + 16);
+    uint8_t* IV = Buffer;
+    uint8_t* Tag = Buffer + 11;
+    uint8_t* Payload = Buffer + 11 + 16;
 
-    memcpy(Output.data(), IV.data(), 11);
-    memcpy(Output.data() + 11, Tag.data(), 16);
-    memcpy(Output.data() + 11 + 16, Payload.data(), Payload.size());
+    FillRandomBytes(IV, 11);
 
-    //Log("EncryptServer: PayloadSize=%i IV=%s Tag=%s Header=%s", Payload.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str());
+    // Header is just the IV.
+    if (!CwcContext.Encrypt(IV, IV, 11, Payload, Size - HEADER_SIZE, Tag))
+    {
+        return false;
+    }
 
     return true;
 }
 
-bool CWCServerUDPCipher::Decrypt(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
+bool CWCServerUDPCipher::DecryptInPlace(uint8_t* Buffer, size_t Size)
 {
-    std::vector<uint8_t> IV(11);
-    std::vector<uint8_t> Tag(16);
-
     // Actually enough data for any data?
-    if (Input.size() < 11 + 16 + 1)
+    if (Size < HEADER_SIZE + 1)
     {
         return false;
     }
 
-    Output.resize(Input.size() - 11 - 16);
-
-    memcpy(IV.data(), Input.data(), 11);
-    memcpy(Tag.data(), Input.data() + 11, 16);
-    memcpy(Output.data(), Input.data() + 11 + 16, Output.size());
-
-    std::vector<uint8_t> Header;
-    Header.resize(11);
-    memcpy(Header.data(), IV.data(), 11);
-
-    //Log("DecryptServer: PayloadSize=%i IV=%s Tag=%s Header=%s", Output.size(), BytesToHex(IV).c_str(), BytesToHex(Tag).c_str(), BytesToHex(Header).c_str());
+    uint8_t* IV = Buffer;
+    uint8_t* Tag = Buffer + 11;
+    uint8_t* Payload = Buffer + 11 + 16;
 
-    if (cwc_decrypt_message(IV.data(), 11, Header.data(), (unsigned long)Header.size(), (unsigned char*)Output.data(), (unsigned long)Output.size(), Tag.data(), 16, &CwcContext) == RETURN_ERROR)
+    if (!CwcContext.Decrypt(IV, IV, 11, Payload, Size - HEADER_SIZE, Tag))
     {
         return false;
     }
@@ -11,7 +11,7 @@
 
 #include "Core/Crypto/Cipher.h"
 
-#include "cwc.h"
+#include "Core/Crypto/CWCContext.h"
 
 #include <vector>
 
@@ -25,12 +25,19 @@ public:
     bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
     bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) override;
 
+    size_t GetHeaderSize() override { return HEADER_SIZE; }
+    bool EncryptInPlace(uint8_t* Buffer, size_t Size) override;
+    bool DecryptInPlace(uint8_t* Buffer, size_t Size) override;
+
 private:
     std::vector<uint8_t> Key;
 
-    cwc_ctx CwcContext;
+    CWCContext CwcContext;
     
     uint64_t AuthToken;
     std::vector<uint8_t> AuthTokenHeaderBytes;
 
+    // IV + Tag
+    static inline const size_t HEADER_SIZE = 11 + 16;
+
 };
@@ -10,6 +10,8 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 
 class Cipher
 {
@@ -20,4 +22,15 @@ public:
     virtual bool Encrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) = 0;
     virtual bool Decrypt(const std::vector<uint8_t>& input, std::vector<uint8_t>& Output) = 0;
 
+    // In-place versions of the above, for ciphers whose output is just the input with a fixed
+    // size header (iv, tag, etc) in front of it. These don't allocate, which matters for
+    // ciphers that run on every datagram. Ciphers that don't support them return false.
+    //
+    // Buffer and Size cover the whole ciphertext, header included. When encrypting the caller
+    // reserves GetHeaderSize() bytes at the start of the buffer and puts the plaintext after
+    // them, when decrypting the plaintext is left in the same place.
+    virtual size_t GetHeaderSize() { return 0; }
+    virtual bool EncryptInPlace(uint8_t* Buffer, size_t Size) { return false; }
+    virtual bool DecryptInPlace(uint8_t* Buffer, size_t Size) { return false; }
+
 };
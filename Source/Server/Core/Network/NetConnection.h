@@ -19,8 +19,10 @@
 // that is used (TCP / UDP).
 
 #include "Core/Network/NetIPAddress.h"
+#include "Core/Utils/PacketBuffer.h"
 
 class Cipher;
+class NetEventLoop;
 
 class NetConnection
 {
@@ -40,6 +42,35 @@ public:
     virtual bool Recieve(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) = 0; 
     virtual bool Send(const std::vector<uint8_t>& Buffer, int Offset, int Count) = 0;
 
+    // Recieves the next packet into a packet buffer, the buffer is left empty if there is 
+    // nothing to recieve. Connections that queue up whole packets (eg. udp) hand them over 
+    // without copying them.
+    virtual bool Recieve(PacketBuffer& Buffer)
+    {
+        std::vector<uint8_t> Data(BuildConfig::UDP_MAX_DATAGRAM_SIZE);
+        int BytesRecieved = 0;
+        if (!Recieve(Data, 0, (int)Data.size(), BytesRecieved))
+        {
+            return false;
+        }
+
+        Data.resize(BytesRecieved);
+        Buffer = PacketBuffer(std::move(Data));
+        return true;
+    }
+
+    // Sends the contents of a packet buffer. Connections that hold onto data after 
+    // Send returns (eg. batched udp) can keep a reference to the buffer rather than 
+    // copying it, so the buffer must not be modified after it has been sent.
+    virtual bool Send(const PacketBuffer& Buffer)
+    {
+        if (Buffer.Empty())
+        {
+            return true;
+        }
+        return Send(Buffer.GetStorage(), (int)Buffer.GetOffset(), (int)Buffer.Size());
+    }
+
     virtual bool Disconnect() = 0;
 
     virtual bool IsConnected() = 0;
@@ -48,4 +79,9 @@ public:
     virtual std::string GetName() = 0;
     virtual void Rename(const std::string& Name) = 0;
 
+    // Registers the connections socket with the given event loop so it wakes
+    // up when data is available. Connections accepted from a listening
+    // connection are registered with the same loop.
+    virtual void SetEventLoop(NetEventLoop* Loop) = 0;
+
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "Core/Utils/Logging.h"
 #include "Config/BuildConfig.h"
 #include "Core/Crypto/Cipher.h"
+#include "Core/Network/NetEventLoop.h"
 
 NetConnectionTCP::NetConnectionTCP(const std::string& InName)
     : Name(InName)
@@ -101,6 +102,11 @@ bool NetConnectionTCP::Listen(int Port)
         return false;
     }
 
+    if (EventLoop)
+    {
+        EventLoop->AddSocket(Socket);
+    }
+
     return true;
 }
 
@@ -130,7 +136,10 @@ std::shared_ptr<NetConnection> NetConnectionTCP::Accept()
             ClientAddress.sin_addr.S_un.S_un_b.s_b3, 
             ClientAddress.sin_addr.S_un.S_un_b.s_b4);
 
-        return std::make_shared<NetConnectionTCP>(NewSocket, ClientName.data(), NetClientAddress);
+        std::shared_ptr<NetConnectionTCP> NewConnection = std::make_shared<NetConnectionTCP>(NewSocket, ClientName.data(), NetClientAddress);
+        NewConnection->SetEventLoop(EventLoop);
+        
+        return NewConnection;
     }
 
     return nullptr;
@@ -295,6 +304,8 @@ bool NetConnectionTCP::Send(const std::vector<uint8_t>& Buffer, int Offset, int
 
     memcpy(SendQueue.data() + InsertOffset, CipheredBuffer.data(), CipheredBuffer.size());
 
+    UpdateWriteInterest();
+
     return true;
 }
 
@@ -342,6 +353,11 @@ bool NetConnectionTCP::Disconnect()
         return false;
     }
 
+    if (EventLoop)
+    {
+        EventLoop->RemoveSocket(Socket);
+    }
+
     closesocket(Socket);
     Socket = INVALID_SOCKET_VALUE;
     
@@ -358,6 +374,26 @@ void NetConnectionTCP::Rename(const std::string& InName)
     Name = InName;
 }
 
+void NetConnectionTCP::SetEventLoop(NetEventLoop* Loop)
+{
+    if (Socket != INVALID_SOCKET_VALUE)
+    {
+        if (EventLoop)
+        {
+            EventLoop->RemoveSocket(Socket);
+        }
+        if (Loop)
+        {
+            Loop->AddSocket(Socket);
+        }
+    }
+
+    EventLoop = Loop;
+    bWantsWrite = false;
+
+    UpdateWriteInterest();
+}
+
 bool NetConnectionTCP::IsConnected()
 {
     if (HasDisconnected)
@@ -398,5 +434,21 @@ bool NetConnectionTCP::Pump()
         }
     }
 
+    UpdateWriteInterest();
+
     return false;
+}
+
+void NetConnectionTCP::UpdateWriteInterest()
+{
+    bool bHasQueuedData = !SendQueue.empty();
+    if (EventLoop == nullptr || Socket == INVALID_SOCKET_VALUE || bHasQueuedData == bWantsWrite)
+    {
+        return;
+    }
+
+    if (EventLoop->SetSocketWantsWrite(Socket, bHasQueuedData))
+    {
+        bWantsWrite = bHasQueuedData;
+    }
 }
\ No newline at end of file
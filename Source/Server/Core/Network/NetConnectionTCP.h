@@ -52,6 +52,8 @@ public:
     virtual bool Peek(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
     virtual bool Recieve(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
     virtual bool Send(const std::vector<uint8_t>& Buffer, int Offset, int Count) override;
+    using NetConnection::Send;
+    using NetConnection::Recieve;
 
     virtual bool Disconnect() override;
 
@@ -62,10 +64,16 @@ public:
     virtual std::string GetName() override;
     virtual void Rename(const std::string& Name) override;
 
+    virtual void SetEventLoop(NetEventLoop* Loop) override;
+
 protected:
 
     bool SendPartial(const std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesSent);
 
+    // Asks the event loop to wake us when the socket is writable while we have 
+    // queued data, so it gets sent as soon as the socket will take it.
+    void UpdateWriteInterest();
+
 private:
     std::string Name;
     NetIPAddress IPAddress;
@@ -76,4 +84,7 @@ private:
 
     std::vector<uint8_t> SendQueue;
 
+    NetEventLoop* EventLoop = nullptr;
+    bool bWantsWrite = false;
+
 };
\ No newline at end of file
@@ -11,11 +11,39 @@
 #include "Core/Utils/Logging.h"
 #include "Config/BuildConfig.h"
 #include "Core/Crypto/Cipher.h"
+#include "Core/Network/NetEventLoop.h"
+#include "Platform/Platform.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+namespace 
+{
+    int GetLastSocketError()
+    {
+#if defined(_WIN32)
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
+    }
+
+    bool IsWouldBlockError(int Error)
+    {
+#if defined(_WIN32)
+        return Error == WSAEWOULDBLOCK;
+#else        
+        return Error == EWOULDBLOCK || Error == EAGAIN;
+#endif
+    }
+};
 
 NetConnectionUDP::NetConnectionUDP(const std::string& InName)
     : Name(InName)
 {
-    RecieveBuffer.resize(64 * 1024);
+    RecieveBuffer.resize(BuildConfig::UDP_MAX_DATAGRAM_SIZE);
 }
 
 NetConnectionUDP::NetConnectionUDP(SocketType ParentSocket, sockaddr_in InDestination, const std::string& InName, const NetIPAddress& InAddress)
@@ -29,6 +57,15 @@ NetConnectionUDP::NetConnectionUDP(SocketType ParentSocket, sockaddr_in InDestin
 
 NetConnectionUDP::~NetConnectionUDP()
 {
+    if (bChild)
+    {
+        if (std::shared_ptr<NetConnectionUDP> ParentConnection = Parent.lock())
+        {
+            std::scoped_lock lock(ParentConnection->StaleChildKeysMutex);
+            ParentConnection->StaleChildKeys.push_back(GetAddressKey(Destination));
+        }
+    }
+
     if (Socket != INVALID_SOCKET_VALUE)
     {
         Disconnect();
@@ -58,6 +95,22 @@ bool NetConnectionUDP::Listen(int Port)
         return false;        
     }
 
+    // Allow multiple sockets to bind to the same port, the kernel will spread
+    // incoming datagrams between them based on the source address.
+    if (bReusePort)
+    {
+#if defined(SO_REUSEPORT)
+        if (setsockopt(Socket, SOL_SOCKET, SO_REUSEPORT, (const char*)&const_1, sizeof(const_1)))
+        {
+            ErrorS(GetName().c_str(), "Failed to set socket options: SO_REUSEPORT");
+            return false;
+        }
+#else
+        ErrorS(GetName().c_str(), "SO_REUSEPORT is not supported on this platform.");
+        return false;
+#endif
+    }
+
     // Set socket to non-blocking mode.
 #if defined(_WIN32)
     unsigned long mode = 1;
@@ -93,6 +146,11 @@ bool NetConnectionUDP::Listen(int Port)
 
     bListening = true;
 
+    if (EventLoop)
+    {
+        EventLoop->AddSocket(Socket);
+    }
+
     return true;
 }
 
@@ -211,37 +269,94 @@ bool NetConnectionUDP::Recieve(std::vector<uint8_t>& Buffer, int Offset, int Cou
         return true;
     }
 
-    std::vector<uint8_t> NextPacket = RecieveQueue[0];
+    std::vector<uint8_t>& NextPacket = RecieveQueue[0];
     if (NextPacket.size() > Count)
     {
         ErrorS(GetName().c_str(), "Unable to recieve next udp packet, packet is larger than buffer. Packets must be recieved in their entirety.");
         return false;
     }
-    RecieveQueue.erase(RecieveQueue.begin());
 
     memcpy(Buffer.data() + Offset, NextPacket.data(), NextPacket.size());
     BytesRecieved = (int)NextPacket.size();
 
+    RecieveQueue.erase(RecieveQueue.begin());
+
+    return true;
+}
+
+bool NetConnectionUDP::Recieve(PacketBuffer& Buffer)
+{
+    if (RecieveQueue.size() == 0)
+    {
+        Buffer = PacketBuffer();
+        return true;
+    }
+
+    // Datagrams are queued in their own exactly sized vectors, so we can just hand it over.
+    Buffer = PacketBuffer(std::move(RecieveQueue[0]));
+    RecieveQueue.erase(RecieveQueue.begin());
+
     return true;
 }
 
 bool NetConnectionUDP::Send(const std::vector<uint8_t>& Buffer, int Offset, int Count)
 {
-    int Result = sendto(Socket, (char*)Buffer.data() + Offset, Count, 0, (sockaddr*)&Destination, sizeof(sockaddr_in));
+    // Children of a batched listener just queue their datagrams, they 
+    // get sent in one go when the parent is flushed.
+    if (bChild)
+    {
+        if (std::shared_ptr<NetConnectionUDP> ParentConnection = Parent.lock(); ParentConnection && ParentConnection->bBatchedIO)
+        {
+            return QueueOnParent(ParentConnection.get(), PacketBuffer(Buffer.data() + Offset, Count, 0));
+        }
+    }
+
+    return SendImmediate(Destination, Buffer.data() + Offset, Count);
+}
+
+bool NetConnectionUDP::Send(const PacketBuffer& Buffer)
+{
+    // Same as above, but the queue can just hold a reference to the buffer rather than copying it.
+    if (bChild)
+    {
+        if (std::shared_ptr<NetConnectionUDP> ParentConnection = Parent.lock(); ParentConnection && ParentConnection->bBatchedIO)
+        {
+            return QueueOnParent(ParentConnection.get(), Buffer);
+        }
+    }
+
+    return SendImmediate(Destination, Buffer.Data(), (int)Buffer.Size());
+}
+
+bool NetConnectionUDP::QueueOnParent(NetConnectionUDP* ParentConnection, const PacketBuffer& Buffer)
+{
+    std::scoped_lock lock(ParentConnection->SendBatchMutex);
+
+    if (ParentConnection->PendingSendBatch.size() >= BuildConfig::UDP_MAX_PENDING_SEND_BATCH)
+    {
+        // Treat this like a datagram lost on the wire rather than a socket error, the
+        // reliable layer will retransmit it.
+        ParentConnection->Statistics.DatagramsSendDropped++;
+        return true;
+    }
+
+    QueuedDatagram& Datagram = ParentConnection->PendingSendBatch.emplace_back();
+    Datagram.Destination = Destination;
+    Datagram.Data = Buffer;
+    return true;
+}
+
+bool NetConnectionUDP::SendImmediate(const sockaddr_in& To, const uint8_t* Data, int Count)
+{
+    int Result = sendto(Socket, (const char*)Data, Count, 0, (const sockaddr*)&To, sizeof(sockaddr_in));
+    Statistics.SendCalls++;
+
     if (Result < 0)
     {
-#if defined(_WIN32)
-        int error = WSAGetLastError();
-#else
-        int error = errno;
-#endif
+        int error = GetLastSocketError();
 
         // Blocking is fine, just return.
-#if defined(_WIN32)
-        if (error == WSAEWOULDBLOCK)
-#else        
-        if (error == EWOULDBLOCK || error == EAGAIN)
-#endif
+        if (IsWouldBlockError(error))
         {
             return false;
         }
@@ -255,18 +370,131 @@ bool NetConnectionUDP::Send(const std::vector<uint8_t>& Buffer, int Offset, int
         return false;
     }
 
-   /* 
-    LogS(GetName().c_str(), ">> %i to %i.%i.%i.%i:%i", Result, 
-        Destination.sin_addr.S_un.S_un_b.s_b1,
-        Destination.sin_addr.S_un.S_un_b.s_b2,
-        Destination.sin_addr.S_un.S_un_b.s_b3,
-        Destination.sin_addr.S_un.S_un_b.s_b4,
-        ntohs(Destination.sin_port));
-    */
+    Statistics.DatagramsSent++;
 
     return true;
 }
 
+bool NetConnectionUDP::Flush()
+{
+    if (Socket == INVALID_SOCKET_VALUE)
+    {
+        return true;
+    }
+
+    // Children can queue datagrams from other threads, so swap the batch
+    // out and send it without holding the lock.
+    std::vector<QueuedDatagram> SendBatch;
+    {
+        std::scoped_lock lock(SendBatchMutex);
+        SendBatch.swap(PendingSendBatch);
+    }
+
+    if (SendBatch.empty())
+    {
+        return true;
+    }
+
+    size_t DatagramsFlushed = 0;
+    bool bSuccess = true;
+
+#if defined(__linux__)
+    std::vector<mmsghdr> Headers(SendBatch.size());
+    std::vector<iovec> Vectors(SendBatch.size());
+    for (size_t i = 0; i < SendBatch.size(); i++)
+    {
+        Vectors[i].iov_base = SendBatch[i].Data.Data();
+        Vectors[i].iov_len = SendBatch[i].Data.Size();
+
+        memset(&Headers[i], 0, sizeof(mmsghdr));
+        Headers[i].msg_hdr.msg_name = &SendBatch[i].Destination;
+        Headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        Headers[i].msg_hdr.msg_iov = &Vectors[i];
+        Headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (DatagramsFlushed < SendBatch.size())
+    {
+        int Result = sendmmsg(Socket, Headers.data() + DatagramsFlushed, (unsigned int)(SendBatch.size() - DatagramsFlushed), 0);
+        Statistics.SendCalls++;
+
+        if (Result < 0)
+        {
+            int error = GetLastSocketError();
+            if (!IsWouldBlockError(error))
+            {
+                ErrorS(GetName().c_str(), "Failed to send batch with error 0x%08x.", error);
+                bSuccess = false;
+            }
+            break;
+        }
+
+        DatagramsFlushed += Result;
+        Statistics.DatagramsSent += Result;
+    }
+#else
+    // No batched send available, fall back to sending each datagram individually. 
+    for (; DatagramsFlushed < SendBatch.size(); DatagramsFlushed++)
+    {
+        QueuedDatagram& Datagram = SendBatch[DatagramsFlushed];
+        if (!SendImmediate(Datagram.Destination, Datagram.Data.Data(), (int)Datagram.Data.Size()))
+        {
+            if (IsWouldBlockError(GetLastSocketError()))
+            {
+                break;
+            }
+
+            // Drop the datagram, the reliable layer will retransmit if it cares.
+            bSuccess = false;
+        }
+    }
+#endif
+
+    // Anything left over (socket buffer full) gets retried on the next flush. If children 
+    // have queued enough since the swap to go over the limit, the newest datagrams are dropped.
+    if (DatagramsFlushed < SendBatch.size())
+    {
+        std::scoped_lock lock(SendBatchMutex);
+        PendingSendBatch.insert(PendingSendBatch.begin(), std::make_move_iterator(SendBatch.begin() + DatagramsFlushed), std::make_move_iterator(SendBatch.end()));
+
+        if (PendingSendBatch.size() > BuildConfig::UDP_MAX_PENDING_SEND_BATCH)
+        {
+            Statistics.DatagramsSendDropped += PendingSendBatch.size() - BuildConfig::UDP_MAX_PENDING_SEND_BATCH;
+            PendingSendBatch.resize(BuildConfig::UDP_MAX_PENDING_SEND_BATCH);
+        }
+    }
+
+    return bSuccess;
+}
+
+NetConnectionUDPStatistics NetConnectionUDP::GetStatistics()
+{
+    NetConnectionUDPStatistics Result;
+    Result.RecieveCalls = Statistics.RecieveCalls;
+    Result.DatagramsRecieved = Statistics.DatagramsRecieved;
+    Result.SendCalls = Statistics.SendCalls;
+    Result.DatagramsSent = Statistics.DatagramsSent;
+    Result.LastDrainTime = Statistics.LastDrainTime;
+    Result.PeakDrainTime = Statistics.PeakDrainTime;
+    Result.DatagramsRateLimited = Statistics.DatagramsRateLimited;
+    Result.DatagramsRejected = Statistics.DatagramsRejected;
+    Result.DatagramsSendDropped = Statistics.DatagramsSendDropped;
+    return Result;
+}
+
+void NetConnectionUDP::ResetStatistics()
+{
+    Statistics.RecieveCalls = 0;
+    Statistics.DatagramsRecieved = 0;
+    Statistics.SendCalls = 0;
+    Statistics.DatagramsSent = 0;
+    Statistics.LastDrainTime = 0.0;
+    Statistics.PeakDrainTime = 0.0;
+    Statistics.DatagramsRateLimited = 0;
+    Statistics.DatagramsRejected = 0;
+    Statistics.DatagramsSendDropped = 0;
+}
+
 bool NetConnectionUDP::Disconnect()
 {
     if (Socket == INVALID_SOCKET_VALUE)
@@ -276,6 +504,10 @@ bool NetConnectionUDP::Disconnect()
 
     if (!bChild)
     {
+        if (EventLoop)
+        {
+            EventLoop->RemoveSocket(Socket);
+        }
         closesocket(Socket);
     }
     Socket = INVALID_SOCKET_VALUE;
@@ -293,6 +525,30 @@ void NetConnectionUDP::Rename(const std::string& InName)
     Name = InName;
 }
 
+void NetConnectionUDP::SetEventLoop(NetEventLoop* Loop)
+{
+    // Children share their parents socket, so the parent is the only one
+    // who needs to be registered.
+    if (bChild)
+    {
+        return;
+    }
+
+    if (Socket != INVALID_SOCKET_VALUE)
+    {
+        if (EventLoop)
+        {
+            EventLoop->RemoveSocket(Socket);
+        }
+        if (Loop)
+        {
+            Loop->AddSocket(Socket);
+        }
+    }
+
+    EventLoop = Loop;
+}
+
 bool NetConnectionUDP::IsConnected()
 {
     // No way of telling with UDP, assume yes.
@@ -309,94 +565,287 @@ bool NetConnectionUDP::Pump()
     if (!bChild)
     {
         // Recieve any pending datagrams and route to the appropriate child recieve queue.
+        auto DrainStart = std::chrono::high_resolution_clock::now();
+
+        if (bBatchedIO)
+        {
+            PumpBatched();
+        }
+        else
+        {
+            PumpSingle();
+        }
+
+        double DrainTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - DrainStart).count();
+        Statistics.LastDrainTime = DrainTime;
+        if (DrainTime > Statistics.PeakDrainTime)
+        {
+            Statistics.PeakDrainTime = DrainTime;
+        }
+    }
+
+    ReclaimStaleChildren();
+
+    return false;
+}
+
+uint64_t NetConnectionUDP::GetAddressKey(const sockaddr_in& Address)
+{
+    return (static_cast<uint64_t>(Address.sin_addr.S_un.S_addr) << 16) | static_cast<uint64_t>(Address.sin_port);
+}
+
+void NetConnectionUDP::ReclaimStaleChildren()
+{
+    std::scoped_lock lock(StaleChildKeysMutex);
+
+    if (StaleChildKeys.empty())
+    {
+        return;
+    }
+
+    size_t ReclaimCount = StaleChildKeys.size();
+    if (ReclaimCount > BuildConfig::UDP_CHILD_RECLAIM_BATCH_SIZE)
+    {
+        ReclaimCount = BuildConfig::UDP_CHILD_RECLAIM_BATCH_SIZE;
+    }
+
+    for (size_t i = 0; i < ReclaimCount; i++)
+    {
+        // The entry may have been replaced by a new connection from the same address
+        // since the key was queued, so only remove it if its actually dead.
+        if (auto iter = ChildConnections.find(StaleChildKeys[i]); iter != ChildConnections.end() && iter->second.expired())
+        {
+            ChildConnections.erase(iter);
+        }
+    }
+
+    StaleChildKeys.erase(StaleChildKeys.begin(), StaleChildKeys.begin() + ReclaimCount);
+}
+
+void NetConnectionUDP::PumpSingle()
+{
+    socklen_t SourceAddressSize = sizeof(struct sockaddr);
+    sockaddr_in SourceAddress = { 0 };
+
+    int Result = recvfrom(Socket, (char*)RecieveBuffer.data(), (int)RecieveBuffer.size(), 0, (sockaddr*)&SourceAddress, &SourceAddressSize);
+    Statistics.RecieveCalls++;
+
+    if (Result < 0)
+    {
+        int error = GetLastSocketError();
+
+        // Blocking is fine, just return.
+        if (IsWouldBlockError(error))
+        {
+            return;
+        }
+
+        ErrorS(GetName().c_str(), "Failed to recieve with error 0x%08x.", error);
+        return;
+    }
+    else if (Result > 0)
+    {
+        Statistics.DatagramsRecieved++;
+
+        RouteDatagram(SourceAddress, RecieveBuffer.data(), Result);
+
+        //LogS(GetName().c_str(), "<< %i", Result);
+    }
+}
+
+void NetConnectionUDP::PumpBatched()
+{
+    const int BatchSize = BuildConfig::UDP_RECIEVE_BATCH_SIZE;
+
+    if (BatchRecieveBuffers.size() != BatchSize)
+    {
+        BatchRecieveBuffers.resize(BatchSize);
+        for (std::vector<uint8_t>& Buffer : BatchRecieveBuffers)
+        {
+            Buffer.resize(BuildConfig::UDP_MAX_DATAGRAM_SIZE);
+        }
+    }
 
+    int TotalRecieved = 0;
+
+#if defined(__linux__)
+    std::vector<mmsghdr> Headers(BatchSize);
+    std::vector<iovec> Vectors(BatchSize);
+    std::vector<sockaddr_in> SourceAddresses(BatchSize);
+
+    while (TotalRecieved < BuildConfig::UDP_MAX_DATAGRAMS_PER_PUMP)
+    {
+        for (int i = 0; i < BatchSize; i++)
+        {
+            Vectors[i].iov_base = BatchRecieveBuffers[i].data();
+            Vectors[i].iov_len = BatchRecieveBuffers[i].size();
+
+            memset(&Headers[i], 0, sizeof(mmsghdr));
+            Headers[i].msg_hdr.msg_name = &SourceAddresses[i];
+            Headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            Headers[i].msg_hdr.msg_iov = &Vectors[i];
+            Headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int Result = recvmmsg(Socket, Headers.data(), BatchSize, MSG_DONTWAIT, nullptr);
+        Statistics.RecieveCalls++;
+
+        if (Result < 0)
+        {
+            int error = GetLastSocketError();
+            if (!IsWouldBlockError(error))
+            {
+                ErrorS(GetName().c_str(), "Failed to recieve batch with error 0x%08x.", error);
+            }
+            break;
+        }
+
+        for (int i = 0; i < Result; i++)
+        {
+            if (Headers[i].msg_len > 0)
+            {
+                RouteDatagram(SourceAddresses[i], BatchRecieveBuffers[i].data(), (int)Headers[i].msg_len);
+            }
+        }
+
+        Statistics.DatagramsRecieved += Result;
+        TotalRecieved += Result;
+
+        // Socket is drained.
+        if (Result < BatchSize)
+        {
+            break;
+        }
+    }
+#else
+    // No batched recieve available, so just keep calling recvfrom until the socket runs dry.
+    std::vector<uint8_t>& Buffer = BatchRecieveBuffers[0];
+    while (TotalRecieved < BuildConfig::UDP_MAX_DATAGRAMS_PER_PUMP)
+    {
         socklen_t SourceAddressSize = sizeof(struct sockaddr);
         sockaddr_in SourceAddress = { 0 };
 
-        int Result = recvfrom(Socket, (char*)RecieveBuffer.data(), (int)RecieveBuffer.size(), 0, (sockaddr*)&SourceAddress, &SourceAddressSize);
+        int Result = recvfrom(Socket, (char*)Buffer.data(), (int)Buffer.size(), 0, (sockaddr*)&SourceAddress, &SourceAddressSize);
+        Statistics.RecieveCalls++;
+
         if (Result < 0)
         {
-    #if defined(_WIN32)
-            int error = WSAGetLastError();
-    #else
-            int error = errno;
-    #endif
-
-            // Blocking is fine, just return.
-    #if defined(_WIN32)
-            if (error == WSAEWOULDBLOCK)
-    #else        
-            if (error == EWOULDBLOCK || error == EAGAIN)
-    #endif
+            int error = GetLastSocketError();
+            if (!IsWouldBlockError(error))
             {
-                return false;
+                ErrorS(GetName().c_str(), "Failed to recieve with error 0x%08x.", error);
             }
-
-            ErrorS(GetName().c_str(), "Failed to recieve with error 0x%08x.", error);
-            return false;
+            break;
         }
         else if (Result > 0)
         {
-            std::vector<uint8_t> Packet(RecieveBuffer.data(), RecieveBuffer.data() + Result);
+            RouteDatagram(SourceAddress, Buffer.data(), Result);
+        }
+
+        Statistics.DatagramsRecieved++;
+        TotalRecieved++;
+    }
+#endif
+}
+
+bool NetConnectionUDP::CheckPeerRateLimit(uint32_t Address)
+{
+    double CurrentTime = GetSeconds();
 
-            if (bListening)
+    // Periodically forget about addresses whose buckets have refilled, they are 
+    // no different from an address we have never seen.
+    if (CurrentTime >= NextPeerRateLimitPrune)
+    {
+        double RefillTime = BuildConfig::UDP_NEW_PEER_DATAGRAM_BURST / BuildConfig::UDP_NEW_PEER_DATAGRAMS_PER_SECOND;
+        for (auto iter = PeerRateLimits.begin(); iter != PeerRateLimits.end(); /* empty */)
+        {
+            if (CurrentTime - iter->second.LastUpdateTime >= RefillTime)
             {
-                // See if this came from a source we have an existing connection for.
-                bool bRoutedPacket = false;
-                for (auto ConnectionWeakPtr : ChildConnections)
-                {
-                    if (std::shared_ptr<NetConnectionUDP> Connection = ConnectionWeakPtr.lock())
-                    {
-                        if (Connection->Destination.sin_addr.S_un.S_addr == SourceAddress.sin_addr.S_un.S_addr &&
-                            Connection->Destination.sin_port == SourceAddress.sin_port)
-                        {
-                            Connection->RecieveQueue.push_back(Packet);
-                            bRoutedPacket = true;
-                            break;
-                        }
-                    }
-                }
-
-                // Otherwise create a new connection and use that.
-                if (!bRoutedPacket)
-                {
-                    std::vector<char> ClientName;
-                    ClientName.resize(64);
-                    snprintf(ClientName.data(), ClientName.size(), "%s:%s:%i", Name.c_str(), inet_ntoa(SourceAddress.sin_addr), SourceAddress.sin_port);
-
-                    NetIPAddress NetClientAddress(
-                        SourceAddress.sin_addr.S_un.S_un_b.s_b1,
-                        SourceAddress.sin_addr.S_un.S_un_b.s_b2,
-                        SourceAddress.sin_addr.S_un.S_un_b.s_b3,
-                        SourceAddress.sin_addr.S_un.S_un_b.s_b4);
-
-                    std::shared_ptr<NetConnectionUDP> NewConnection = std::make_shared<NetConnectionUDP>(Socket, SourceAddress, ClientName.data(), NetClientAddress);
-                    NewConnection->RecieveQueue.push_back(Packet);
-                    NewConnections.push_back(NewConnection);
-                    ChildConnections.push_back(NewConnection);
-                }
+                iter = PeerRateLimits.erase(iter);
             }
             else
             {
-                RecieveQueue.push_back(Packet);
+                iter++;
             }
-
-            //LogS(GetName().c_str(), "<< %i", Result);
         }
+
+        NextPeerRateLimitPrune = CurrentTime + RefillTime;
     }
 
-    // Clear out and children who have gone stale.
-    for (auto iter = ChildConnections.begin(); iter != ChildConnections.end(); /*empty*/)
+    auto iter = PeerRateLimits.find(Address);
+    if (iter == PeerRateLimits.end())
     {
-        if ((*iter).expired())
+        if (PeerRateLimits.size() >= BuildConfig::UDP_MAX_RATE_LIMITED_ADDRESSES)
         {
-            iter = ChildConnections.erase(iter);
+            return false;
         }
-        else
+
+        iter = PeerRateLimits.insert({ Address, { BuildConfig::UDP_NEW_PEER_DATAGRAM_BURST, CurrentTime } }).first;
+    }
+
+    PeerRateLimit& Limit = iter->second;
+    Limit.Tokens += (CurrentTime - Limit.LastUpdateTime) * BuildConfig::UDP_NEW_PEER_DATAGRAMS_PER_SECOND;
+    if (Limit.Tokens > BuildConfig::UDP_NEW_PEER_DATAGRAM_BURST)
+    {
+        Limit.Tokens = BuildConfig::UDP_NEW_PEER_DATAGRAM_BURST;
+    }
+    Limit.LastUpdateTime = CurrentTime;
+
+    if (Limit.Tokens < 1.0)
+    {
+        return false;
+    }
+
+    Limit.Tokens -= 1.0;
+    return true;
+}
+
+void NetConnectionUDP::RouteDatagram(const sockaddr_in& SourceAddress, const uint8_t* Data, int Length)
+{
+    if (!bListening)
+    {
+        RecieveQueue.emplace_back(Data, Data + Length);
+        return;
+    }
+
+    // See if this came from a source we have an existing connection for.
+    uint64_t AddressKey = GetAddressKey(SourceAddress);
+    if (auto iter = ChildConnections.find(AddressKey); iter != ChildConnections.end())
+    {
+        if (std::shared_ptr<NetConnectionUDP> Connection = iter->second.lock())
         {
-            iter++;
+            Connection->RecieveQueue.emplace_back(Data, Data + Length);
+            return;
         }
     }
 
-    return false;
+    // Otherwise its a new peer. Make sure its worth creating a connection for before 
+    // we allocate anything for it.
+    if (!CheckPeerRateLimit(SourceAddress.sin_addr.S_un.S_addr))
+    {
+        Statistics.DatagramsRateLimited++;
+        return;
+    }
+
+    NetIPAddress NetClientAddress(
+        SourceAddress.sin_addr.S_un.S_un_b.s_b1,
+        SourceAddress.sin_addr.S_un.S_un_b.s_b2,
+        SourceAddress.sin_addr.S_un.S_un_b.s_b3,
+        SourceAddress.sin_addr.S_un.S_un_b.s_b4);
+
+    if (Admission && !Admission(NetClientAddress, Data, Length))
+    {
+        Statistics.DatagramsRejected++;
+        return;
+    }
+
+    std::vector<char> ClientName;
+    ClientName.resize(64);
+    snprintf(ClientName.data(), ClientName.size(), "%s:%s:%i", Name.c_str(), inet_ntoa(SourceAddress.sin_addr), SourceAddress.sin_port);
+
+    std::shared_ptr<NetConnectionUDP> NewConnection = std::make_shared<NetConnectionUDP>(Socket, SourceAddress, ClientName.data(), NetClientAddress);
+    NewConnection->Parent = weak_from_this();
+    NewConnection->RecieveQueue.emplace_back(Data, Data + Length);
+    NewConnections.push_back(NewConnection);
+    ChildConnections[AddressKey] = NewConnection;
 }
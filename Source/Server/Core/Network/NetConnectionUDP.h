@@ -12,6 +12,11 @@
 #include "Core/Network/NetConnection.h"
 
 #include <stdlib.h>
+#include <chrono>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN 
@@ -25,8 +30,34 @@
 #include <netinet/in.h>
 #endif
 
+// Counters used to see how well the listening socket is keeping up with
+// the datagrams being sent to it.
+struct NetConnectionUDPStatistics
+{
+    // Number of recieve/send syscalls made and the number of datagrams
+    // they moved. Dividing one by the other gives the batching efficiency.
+    size_t RecieveCalls = 0;
+    size_t DatagramsRecieved = 0;
+    size_t SendCalls = 0;
+    size_t DatagramsSent = 0;
+
+    // How long (in seconds) the last pump spent draining the socket, and
+    // the peak seen since the statistics were last reset.
+    double LastDrainTime = 0.0;
+    double PeakDrainTime = 0.0;
+
+    // Datagrams from addresses without a connection that were dropped, either for 
+    // exceeding the per-ip rate limit or being refused by the admission filter.
+    size_t DatagramsRateLimited = 0;
+    size_t DatagramsRejected = 0;
+
+    // Datagrams queued by children that were dropped because the send batch was full.
+    size_t DatagramsSendDropped = 0;
+};
+
 class NetConnectionUDP
     : public NetConnection
+    , public std::enable_shared_from_this<NetConnectionUDP>
 {
 public:
 #if defined(_WIN32)
@@ -44,6 +75,10 @@ public:
     NetConnectionUDP(const std::string& InName);
     virtual ~NetConnectionUDP();
 
+    // Decides if a datagram from an address we don't have a connection for should create
+    // one. Return false to drop the datagram.
+    using AdmissionFilter = std::function<bool(const NetIPAddress& Address, const uint8_t* Data, int Length)>;
+
     virtual bool Listen(int Port) override;
 
     virtual std::shared_ptr<NetConnection> Accept() override;
@@ -54,7 +89,9 @@ public:
 
     virtual bool Peek(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
     virtual bool Recieve(std::vector<uint8_t>& Buffer, int Offset, int Count, int& BytesRecieved) override;
+    virtual bool Recieve(PacketBuffer& Buffer) override;
     virtual bool Send(const std::vector<uint8_t>& Buffer, int Offset, int Count) override;
+    virtual bool Send(const PacketBuffer& Buffer) override;
 
     virtual bool Disconnect() override;
 
@@ -64,7 +101,60 @@ public:
     virtual std::string GetName() override;
     virtual void Rename(const std::string& Name) override;
 
+    virtual void SetEventLoop(NetEventLoop* Loop) override;
+
+    // When enabled on a listening connection the socket is drained in batches 
+    // each pump (recvmmsg where available), and datagrams sent by child connections
+    // are queued up and sent together when Flush is called.
+    void SetBatchedIO(bool Enabled) { bBatchedIO = Enabled; }
+
+    // Sets SO_REUSEPORT on the socket when listening, so multiple connections
+    // can listen on the same port. Must be called before Listen.
+    void SetReusePort(bool Enabled) { bReusePort = Enabled; }
+
+    // Sends all datagrams queued by child connections while in batched mode.
+    bool Flush();
+
+    // Sets a filter that datagrams from new addresses have to pass (after the per-ip
+    // rate limit) before a connection is created for them. This should be cheap and
+    // stateless, its run before we have allocated anything for the remote peer. May 
+    // be called from whichever thread pumps this connection.
+    void SetAdmissionFilter(AdmissionFilter Filter) { Admission = Filter; }
+
+    // Safe to call from any thread.
+    NetConnectionUDPStatistics GetStatistics();
+    void ResetStatistics();
+
+protected:
+
+    void PumpSingle();
+    void PumpBatched();
+
+    void RouteDatagram(const sockaddr_in& SourceAddress, const uint8_t* Data, int Length);
+
+    bool SendImmediate(const sockaddr_in& To, const uint8_t* Data, int Length);
+
+    // Queues a datagram on our batched parent. If the parent's batch is full the datagram 
+    // is dropped and counted, but this still returns true as it's not a connection error.
+    bool QueueOnParent(NetConnectionUDP* ParentConnection, const PacketBuffer& Buffer);
+
+    // Packs an ipv4 address and port into a single key for the child connection table.
+    static uint64_t GetAddressKey(const sockaddr_in& Address);
+
+    // Removes children that have been destroyed from the connection table.
+    void ReclaimStaleChildren();
+
+    // Token bucket rate limit on datagrams from new peers, keyed by ip address. 
+    // Returns false if the datagram should be dropped.
+    bool CheckPeerRateLimit(uint32_t Address);
+
 private:
+    struct QueuedDatagram
+    {
+        sockaddr_in Destination;
+        PacketBuffer Data;
+    };
+
     std::string Name;
     NetIPAddress IPAddress;
 
@@ -79,6 +169,58 @@ private:
     std::vector<std::vector<uint8_t>> RecieveQueue;
 
     std::vector<std::shared_ptr<NetConnectionUDP>> NewConnections;
-    std::vector<std::weak_ptr<NetConnectionUDP>> ChildConnections;
+
+    // Children we route datagrams to, keyed by their remote address/port (see GetAddressKey).
+    std::unordered_map<uint64_t, std::weak_ptr<NetConnectionUDP>> ChildConnections;
+
+    // Keys of children that have been destroyed and need to be removed 
+    // from ChildConnections. Children add themselves to their parents list
+    // when they are destroyed, and the parent removes them in batches when pumped.
+    std::vector<uint64_t> StaleChildKeys;
+    std::mutex StaleChildKeysMutex;
+
+    // Listening connection that created this child.
+    std::weak_ptr<NetConnectionUDP> Parent;
+
+    bool bBatchedIO = false;
+    bool bReusePort = false;
+
+    NetEventLoop* EventLoop = nullptr;
+
+    // Buffers that batched recieves are written into, one per datagram.
+    std::vector<std::vector<uint8_t>> BatchRecieveBuffers;
+
+    // Datagrams queued by children waiting for the next Flush.
+    std::vector<QueuedDatagram> PendingSendBatch;
+    std::mutex SendBatchMutex;
+
+    // Same as NetConnectionUDPStatistics, but atomic as these are updated by whichever thread
+    // is pumping or sending on the connection (eg. children updating their parents counters
+    // from a shard thread) while being read from others.
+    struct AtomicStatistics
+    {
+        std::atomic<size_t> RecieveCalls = 0;
+        std::atomic<size_t> DatagramsRecieved = 0;
+        std::atomic<size_t> SendCalls = 0;
+        std::atomic<size_t> DatagramsSent = 0;
+        std::atomic<double> LastDrainTime = 0.0;
+        std::atomic<double> PeakDrainTime = 0.0;
+        std::atomic<size_t> DatagramsRateLimited = 0;
+        std::atomic<size_t> DatagramsRejected = 0;
+        std::atomic<size_t> DatagramsSendDropped = 0;
+    };
+
+    AtomicStatistics Statistics;
+
+    AdmissionFilter Admission;
+
+    struct PeerRateLimit
+    {
+        double Tokens;
+        double LastUpdateTime;
+    };
+
+    std::unordered_map<uint32_t, PeerRateLimit> PeerRateLimits;
+    double NextPeerRateLimitPrune = 0.0;
 
 };
\ No newline at end of file
@@ -0,0 +1,315 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Network/NetEventLoop.h"
+#include "Core/Utils/Logging.h"
+#include "Platform/Platform.h"
+
+#include <cmath>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+NetEventLoop::~NetEventLoop()
+{
+    if (bInitialized)
+    {
+        Term();
+    }
+}
+
+#if defined(_WIN32)
+
+bool NetEventLoop::Init()
+{
+    // Wakeups are done by sending a datagram to a socket bound to loopback, which
+    // is the only portable way to interrupt WSAPoll.
+    WakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (WakeSocket == INVALID_SOCKET)
+    {
+        Error("Failed to create event loop wake socket, error %i.", WSAGetLastError());
+        return false;
+    }
+
+    sockaddr_in WakeAddress = {};
+    WakeAddress.sin_family = AF_INET;
+    WakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    WakeAddress.sin_port = 0;
+
+    int WakeAddressSize = sizeof(WakeAddress);
+    if (bind(WakeSocket, (sockaddr*)&WakeAddress, sizeof(WakeAddress)) != 0 ||
+        getsockname(WakeSocket, (sockaddr*)&WakeAddress, &WakeAddressSize) != 0 ||
+        connect(WakeSocket, (sockaddr*)&WakeAddress, sizeof(WakeAddress)) != 0)
+    {
+        Error("Failed to bind event loop wake socket, error %i.", WSAGetLastError());
+        closesocket(WakeSocket);
+        WakeSocket = INVALID_SOCKET;
+        return false;
+    }
+
+    unsigned long mode = 1;
+    if (int result = ioctlsocket(WakeSocket, FIONBIO, &mode); result != 0)
+    {
+        Error("Failed to set event loop wake socket to non blocking with error 0x%08x", result);
+        closesocket(WakeSocket);
+        WakeSocket = INVALID_SOCKET;
+        return false;
+    }
+
+    PollSockets.clear();
+    PollSockets.push_back({ WakeSocket, POLLRDNORM, 0 });
+
+    bInitialized = true;
+    return true;
+}
+
+bool NetEventLoop::Term()
+{
+    if (WakeSocket != INVALID_SOCKET)
+    {
+        closesocket(WakeSocket);
+        WakeSocket = INVALID_SOCKET;
+    }
+
+    PollSockets.clear();
+
+    bInitialized = false;
+    return true;
+}
+
+bool NetEventLoop::AddSocket(SocketType Socket)
+{
+    for (WSAPOLLFD& Entry : PollSockets)
+    {
+        if (Entry.fd == Socket)
+        {
+            return true;
+        }
+    }
+
+    PollSockets.push_back({ Socket, POLLRDNORM, 0 });
+    return true;
+}
+
+bool NetEventLoop::RemoveSocket(SocketType Socket)
+{
+    for (auto iter = PollSockets.begin(); iter != PollSockets.end(); iter++)
+    {
+        if (iter->fd == Socket && Socket != WakeSocket)
+        {
+            PollSockets.erase(iter);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool NetEventLoop::SetSocketWantsWrite(SocketType Socket, bool WantsWrite)
+{
+    for (WSAPOLLFD& Entry : PollSockets)
+    {
+        if (Entry.fd == Socket)
+        {
+            Entry.events = WantsWrite ? (POLLRDNORM | POLLWRNORM) : POLLRDNORM;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool NetEventLoop::Wait(double Deadline)
+{
+    double Remaining = Deadline - GetSeconds();
+    if (Remaining <= 0.0)
+    {
+        return false;
+    }
+
+    int Result = WSAPoll(PollSockets.data(), (ULONG)PollSockets.size(), (int)std::ceil(Remaining * 1000.0));
+    if (Result < 0)
+    {
+        Error("Event loop failed to poll sockets, error %i.", WSAGetLastError());
+        return false;
+    }
+    else if (Result == 0)
+    {
+        return false;
+    }
+
+    // Drain any pending wakeups.
+    if (PollSockets[0].revents != 0)
+    {
+        char Buffer[64];
+        while (recv(WakeSocket, Buffer, sizeof(Buffer), 0) > 0)
+        {
+        }
+    }
+
+    return true;
+}
+
+void NetEventLoop::Wake()
+{
+    if (WakeSocket != INVALID_SOCKET)
+    {
+        char Byte = 0;
+        send(WakeSocket, &Byte, sizeof(Byte), 0);
+    }
+}
+
+#else
+
+bool NetEventLoop::Init()
+{
+    EpollHandle = epoll_create1(EPOLL_CLOEXEC);
+    if (EpollHandle < 0)
+    {
+        Error("Failed to create event loop epoll instance, error %i.", errno);
+        return false;
+    }
+
+    WakeHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    TimerHandle = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (WakeHandle < 0 || TimerHandle < 0)
+    {
+        Error("Failed to create event loop wake/timer handles, error %i.", errno);
+        Term();
+        return false;
+    }
+
+    if (!AddSocket(WakeHandle) || !AddSocket(TimerHandle))
+    {
+        Term();
+        return false;
+    }
+
+    bInitialized = true;
+    return true;
+}
+
+bool NetEventLoop::Term()
+{
+    for (int* Handle : { &TimerHandle, &WakeHandle, &EpollHandle })
+    {
+        if (*Handle >= 0)
+        {
+            close(*Handle);
+            *Handle = -1;
+        }
+    }
+
+    bInitialized = false;
+    return true;
+}
+
+bool NetEventLoop::AddSocket(SocketType Socket)
+{
+    epoll_event Event = {};
+    Event.events = EPOLLIN;
+    Event.data.fd = Socket;
+
+    if (epoll_ctl(EpollHandle, EPOLL_CTL_ADD, Socket, &Event) != 0 && errno != EEXIST)
+    {
+        Error("Failed to add socket to event loop, error %i.", errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool NetEventLoop::RemoveSocket(SocketType Socket)
+{
+    return epoll_ctl(EpollHandle, EPOLL_CTL_DEL, Socket, nullptr) == 0;
+}
+
+bool NetEventLoop::SetSocketWantsWrite(SocketType Socket, bool WantsWrite)
+{
+    epoll_event Event = {};
+    Event.events = WantsWrite ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    Event.data.fd = Socket;
+
+    if (epoll_ctl(EpollHandle, EPOLL_CTL_MOD, Socket, &Event) != 0)
+    {
+        Error("Failed to modify socket in event loop, error %i.", errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool NetEventLoop::Wait(double Deadline)
+{
+    double Remaining = Deadline - GetSeconds();
+    if (Remaining <= 0.0)
+    {
+        return false;
+    }
+
+    itimerspec TimerSpec = {};
+    TimerSpec.it_value.tv_sec = (time_t)Remaining;
+    TimerSpec.it_value.tv_nsec = (long)((Remaining - std::floor(Remaining)) * 1000000000.0);
+
+    // A zero value disarms the timer, which would leave us waiting forever.
+    if (TimerSpec.it_value.tv_sec == 0 && TimerSpec.it_value.tv_nsec == 0)
+    {
+        TimerSpec.it_value.tv_nsec = 1;
+    }
+    timerfd_settime(TimerHandle, 0, &TimerSpec, nullptr);
+
+    const int MaxEvents = 64;
+    epoll_event Events[MaxEvents];
+
+    int Result = epoll_wait(EpollHandle, Events, MaxEvents, -1);
+    if (Result < 0)
+    {
+        if (errno != EINTR)
+        {
+            Error("Event loop failed to wait on epoll, error %i.", errno);
+        }
+        return false;
+    }
+
+    bool bWokenBySocket = false;
+    for (int i = 0; i < Result; i++)
+    {
+        uint64_t Value;
+        if (Events[i].data.fd == TimerHandle)
+        {
+            read(TimerHandle, &Value, sizeof(Value));
+        }
+        else
+        {
+            if (Events[i].data.fd == WakeHandle)
+            {
+                read(WakeHandle, &Value, sizeof(Value));
+            }
+            bWokenBySocket = true;
+        }
+    }
+
+    return bWokenBySocket;
+}
+
+void NetEventLoop::Wake()
+{
+    if (WakeHandle >= 0)
+    {
+        uint64_t Value = 1;
+        write(WakeHandle, &Value, sizeof(Value));
+    }
+}
+
+#endif
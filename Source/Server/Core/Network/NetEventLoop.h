@@ -0,0 +1,76 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN 
+#include <windows.h>
+#include <ws2tcpip.h>
+#include <winsock2.h>
+#endif
+
+// Allows the server to sleep until it has something to do rather than
+// spinning. Connections register their sockets with the loop and Wait
+// blocks until one of them has data to read, a deadline is reached, or
+// Wake is called from another thread.
+//
+// On linux this is built on epoll, with an eventfd used for wakeups and a
+// timerfd for the deadline. On windows it uses WSAPoll, with a loopback
+// socket used for wakeups.
+
+class NetEventLoop
+{
+public:
+#if defined(_WIN32)
+    using SocketType = SOCKET;
+#else
+    using SocketType = int;
+#endif
+
+public:
+    NetEventLoop() = default;
+    ~NetEventLoop();
+
+    bool Init();
+    bool Term();
+
+    // Starts/stops waking the loop when the given socket is readable.
+    bool AddSocket(SocketType Socket);
+    bool RemoveSocket(SocketType Socket);
+
+    // Sets if the loop should also wake when the given (already added) socket is 
+    // writable. Used by connections with queued data the socket wouldn't accept yet.
+    bool SetSocketWantsWrite(SocketType Socket, bool WantsWrite);
+
+    // Blocks until a registered socket is readable (or writable if requested), Wake is called or GetSeconds
+    // reaches Deadline. Returns true if something other than the deadline woke us.
+    bool Wait(double Deadline);
+
+    // Interrupts the current Wait, or if not waiting causes the next
+    // Wait to return immediately. Safe to call from any thread.
+    void Wake();
+
+private:
+    bool bInitialized = false;
+
+#if defined(_WIN32)
+    std::vector<WSAPOLLFD> PollSockets;
+
+    // Loopback socket that Wake sends a byte to, it sits at the start of PollSockets.
+    SocketType WakeSocket = INVALID_SOCKET;
+#else
+    int EpollHandle = -1;
+    int WakeHandle = -1;
+    int TimerHandle = -1;
+#endif
+
+};
@@ -13,52 +13,177 @@
 
 bool Compress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output)
 {
-    uLongf DestinationLength = (uLongf)Output.size();
-
-    Output.resize(compressBound((uLong)Input.size()));
-
-    z_stream defstream;
-    defstream.zalloc = Z_NULL;
-    defstream.zfree = Z_NULL;
-    defstream.opaque = Z_NULL;
-    defstream.avail_in = (uInt)Input.size();
-    defstream.next_in = (Bytef*)Input.data();
-    defstream.avail_out = (uInt)Output.size();
-    defstream.next_out = (Bytef*)Output.data();
-
-    // Match these settings EXACTLY or ds3 has a fit. I think its doing a hard-check on the header
-    // generated which changes based on the settings.
-    if (deflateInit2(&defstream, 7, Z_DEFLATED, 13, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+    return Compress(Input.data(), Input.size(), Output);
+}
+
+namespace 
+{
+    // Setting up a zlib stream allocates a fair chunk of state (~100kb for deflate with the settings
+    // below), so rather than doing it for every message each thread keeps a stream of each type around 
+    // and resets it between uses. A reset stream produces exactly the same output as a new one.
+    struct ZlibContext
+    {
+        z_stream DeflateStream = {};
+        z_stream InflateStream = {};
+        bool DeflateValid = false;
+        bool InflateValid = false;
+
+        ~ZlibContext()
+        {
+            if (DeflateValid)
+            {
+                deflateEnd(&DeflateStream);
+            }
+            if (InflateValid)
+            {
+                inflateEnd(&InflateStream);
+            }
+        }
+
+        z_stream* GetDeflateStream()
+        {
+            if (DeflateValid)
+            {
+                if (deflateReset(&DeflateStream) != Z_OK)
+                {
+                    return nullptr;
+                }
+                return &DeflateStream;
+            }
+
+            DeflateStream.zalloc = Z_NULL;
+            DeflateStream.zfree = Z_NULL;
+            DeflateStream.opaque = Z_NULL;
+
+            // Match these settings EXACTLY or ds3 has a fit. I think its doing a hard-check on the header
+            // generated which changes based on the settings.
+            if (deflateInit2(&DeflateStream, 7, Z_DEFLATED, 13, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return nullptr;
+            }
+
+            DeflateValid = true;
+            return &DeflateStream;
+        }
+
+        z_stream* GetInflateStream()
+        {
+            if (InflateValid)
+            {
+                if (inflateReset(&InflateStream) != Z_OK)
+                {
+                    return nullptr;
+                }
+                return &InflateStream;
+            }
+
+            InflateStream.zalloc = Z_NULL;
+            InflateStream.zfree = Z_NULL;
+            InflateStream.opaque = Z_NULL;
+            InflateStream.next_in = Z_NULL;
+            InflateStream.avail_in = 0;
+
+            if (inflateInit(&InflateStream) != Z_OK)
+            {
+                return nullptr;
+            }
+
+            InflateValid = true;
+            return &InflateStream;
+        }
+    };
+
+    thread_local ZlibContext Context;
+
+    // Output must be at least deflateBound bytes, returns the number of bytes written or 0 on failure.
+    size_t Deflate(z_stream* defstream, const uint8_t* Input, size_t InputSize, uint8_t* Output, size_t OutputSize)
+    {
+        defstream->avail_in = (uInt)InputSize;
+        defstream->next_in = (Bytef*)Input;
+        defstream->avail_out = (uInt)OutputSize;
+        defstream->next_out = (Bytef*)Output;
+
+        if (deflate(defstream, Z_FINISH) != Z_STREAM_END)
+        {
+            return 0;
+        }
+
+        return defstream->total_out;
+    }
+}
+
+bool Compress(const uint8_t* Input, size_t InputSize, std::vector<uint8_t>& Output)
+{
+    z_stream* defstream = Context.GetDeflateStream();
+    if (defstream == nullptr)
     {
         return false;
     }
-    if (deflate(&defstream, Z_FINISH) != Z_STREAM_END)
+
+    // Callers that reuse their output vector won't allocate here once its grown large enough. Note
+    // that compressBound assumes the default settings, its too small for incompressible data with ours.
+    Output.resize(deflateBound(defstream, (uLong)InputSize));
+
+    size_t CompressedSize = Deflate(defstream, Input, InputSize, Output.data(), Output.size());
+    if (CompressedSize == 0)
     {
         return false;
     }
-    if (deflateEnd(&defstream) != Z_OK)
+
+    Output.resize(CompressedSize);
+
+    return true;
+}
+
+bool Compress(const uint8_t* Input, size_t InputSize, PacketBuffer& Output)
+{
+    z_stream* defstream = Context.GetDeflateStream();
+    if (defstream == nullptr)
     {
         return false;
     }
 
-    Output.resize(defstream.total_out);
+    size_t Bound = deflateBound(defstream, (uLong)InputSize);
+    Output = PacketBuffer(Bound);
+
+    size_t CompressedSize = Deflate(defstream, Input, InputSize, Output.Data(), Output.Size());
+    if (CompressedSize == 0)
+    {
+        return false;
+    }
+
+    Output.Trim(Bound - CompressedSize);
 
     return true;
 }
 
 bool Decompress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output, uint32_t DecompressedSize)
 {
+    return Decompress(Input.data(), Input.size(), Output, DecompressedSize);
+}
+
+bool Decompress(const uint8_t* Input, size_t InputSize, std::vector<uint8_t>& Output, uint32_t DecompressedSize)
+{
+    z_stream* infstream = Context.GetInflateStream();
+    if (infstream == nullptr)
+    {
+        return false;
+    }
+
     Output.resize(DecompressedSize);
 
-    uLongf DestinationLength = (uLongf)Output.size();
-    uLongf SourceLength = (uLongf)Input.size();
+    infstream->avail_in = (uInt)InputSize;
+    infstream->next_in = (Bytef*)Input;
+    infstream->avail_out = (uInt)Output.size();
+    infstream->next_out = (Bytef*)Output.data();
 
-    if (uncompress2(Output.data(), &DestinationLength, Input.data(), &SourceLength) != Z_OK)
+    // Same as uncompress, the whole stream has to fit in the output buffer.
+    if (inflate(infstream, Z_FINISH) != Z_STREAM_END)
     {
         return false;
     }
 
-    Output.resize(DestinationLength);
+    Output.resize(infstream->total_out);
 
     return true;
-}
\ No newline at end of file
+}
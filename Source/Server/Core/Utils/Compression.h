@@ -11,6 +11,17 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
+
+#include "Core/Utils/PacketBuffer.h"
 
 bool Compress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output);
-bool Decompress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output, uint32_t DecompressedSize);
\ No newline at end of file
+bool Decompress(const std::vector<uint8_t>& Input, std::vector<uint8_t>& Output, uint32_t DecompressedSize);
+
+// Pointer versions of the above, so callers don't need to copy their data into a vector first.
+bool Compress(const uint8_t* Input, size_t InputSize, std::vector<uint8_t>& Output);
+bool Decompress(const uint8_t* Input, size_t InputSize, std::vector<uint8_t>& Output, uint32_t DecompressedSize);
+
+// Compresses into a newly allocated packet buffer, so the output can be sent on without being
+// copied again. Any space left over from the compression bound is kept as tailroom.
+bool Compress(const uint8_t* Input, size_t InputSize, PacketBuffer& Output);
@@ -0,0 +1,210 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+// This file contains a refcounted byte buffer used to pass packets up and down
+// the network stream stack without copying them at every layer.
+//
+// A buffer is a view onto a block of shared storage. Space is left before
+// (headroom) and after (tailroom) the data so that each layer can prepend its
+// header or strip it off again by just moving the view, rather than
+// allocating a new buffer and copying the payload into it.
+//
+// Copying a buffer is cheap, both copies reference the same storage. Note that
+// copies also share the same headroom/tailroom, so prepending to one copy may
+// overwrite bytes prepended to another. This is fine for the way the streams
+// use them (each layer builds its header, hands the buffer down and is done
+// with it before the next send), but anything that wants to hold onto the
+// prepended bytes should call MakeUnique first.
+//
+// You can use it roughly like this:
+//
+//   PacketBuffer Buffer(PayloadSize);
+//   Serialize(Buffer.Data(), Buffer.Size());
+//   memcpy(Buffer.Prepend(sizeof(Header)), &Header, sizeof(Header));
+//   ...
+//   Buffer.Strip(sizeof(Header));
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "Config/BuildConfig.h"
+
+class PacketBuffer
+{
+public:
+    PacketBuffer() = default;
+
+    // Allocates a zero-filled buffer of the given size.
+    PacketBuffer(size_t InSize, size_t InHeadroom = BuildConfig::PACKET_BUFFER_HEADROOM, size_t InTailroom = 0)
+    {
+        Allocate(InSize, InHeadroom, InTailroom);
+    }
+
+    // Allocates a buffer and copies the given data into it.
+    PacketBuffer(const uint8_t* InData, size_t InSize, size_t InHeadroom = BuildConfig::PACKET_BUFFER_HEADROOM, size_t InTailroom = 0)
+    {
+        Allocate(InSize, InHeadroom, InTailroom);
+        if (InSize > 0)
+        {
+            memcpy(Data(), InData, InSize);
+        }
+    }
+
+    // Takes ownership of an existing vector without copying it. The
+    // resulting buffer has no headroom or tailroom.
+    explicit PacketBuffer(std::vector<uint8_t>&& InData)
+        : Storage(std::make_shared<std::vector<uint8_t>>(std::move(InData)))
+        , Offset(0)
+        , Length(Storage->size())
+    {
+    }
+
+    uint8_t* Data()                 { return Storage ? Storage->data() + Offset : nullptr; }
+    const uint8_t* Data() const     { return Storage ? Storage->data() + Offset : nullptr; }
+    size_t Size() const             { return Length; }
+    bool Empty() const              { return Length == 0; }
+
+    size_t Headroom() const         { return Offset; }
+    size_t Tailroom() const         { return Storage ? Storage->size() - Offset - Length : 0; }
+
+    uint8_t& operator[](size_t Index)               { return Data()[Index]; }
+    const uint8_t& operator[](size_t Index) const   { return Data()[Index]; }
+
+    // Grows the buffer at the front and returns a pointer to the new bytes.
+    // Only reallocates if there is not enough headroom left.
+    uint8_t* Prepend(size_t Count)
+    {
+        if (Count > Headroom())
+        {
+            Reallocate(Count + BuildConfig::PACKET_BUFFER_HEADROOM, Tailroom());
+        }
+
+        Offset -= Count;
+        Length += Count;
+
+        return Data();
+    }
+
+    // Grows the buffer at the back and returns a pointer to the new bytes.
+    // Only reallocates if there is not enough tailroom left.
+    uint8_t* Append(size_t Count)
+    {
+        if (Count > Tailroom())
+        {
+            Reallocate(Headroom(), Count);
+        }
+
+        Length += Count;
+
+        return Data() + Length - Count;
+    }
+
+    // Removes bytes from the front of the buffer, returns false if there are not enough.
+    bool Strip(size_t Count)
+    {
+        if (Count > Length)
+        {
+            return false;
+        }
+
+        Offset += Count;
+        Length -= Count;
+
+        return true;
+    }
+
+    // Removes bytes from the back of the buffer, returns false if there are not enough.
+    bool Trim(size_t Count)
+    {
+        if (Count > Length)
+        {
+            return false;
+        }
+
+        Length -= Count;
+
+        return true;
+    }
+
+    // Empties the buffer. Storage only we reference is kept, with its headroom restored, so 
+    // the buffer can be refilled with Append without allocating. Shared storage is released 
+    // so other buffers referencing it don't have to copy it to make it unique.
+    void Clear()
+    {
+        if (IsShared())
+        {
+            Storage.reset();
+            Offset = 0;
+        }
+        else if (Storage)
+        {
+            Offset = std::min(Storage->size(), (size_t)BuildConfig::PACKET_BUFFER_HEADROOM);
+        }
+        Length = 0;
+    }
+
+    // Returns true if other buffers reference the same storage.
+    bool IsShared() const
+    {
+        return Storage && Storage.use_count() > 1;
+    }
+
+    // Ensures no other buffer references our storage, copying it if required.
+    void MakeUnique()
+    {
+        if (IsShared())
+        {
+            Reallocate(Headroom(), Tailroom());
+        }
+    }
+
+    // The underlying storage and the offset of our data within it, used to hand the
+    // buffer to apis that take a vector and offset (eg. NetConnection::Send).
+    const std::vector<uint8_t>& GetStorage() const  { return *Storage; }
+    size_t GetOffset() const                        { return Offset; }
+
+    // Copies the contents out into a vector, intended for debugging/logging.
+    std::vector<uint8_t> ToVector() const
+    {
+        return std::vector<uint8_t>(Data(), Data() + Length);
+    }
+
+private:
+    void Allocate(size_t InSize, size_t InHeadroom, size_t InTailroom)
+    {
+        Storage = std::make_shared<std::vector<uint8_t>>(InHeadroom + InSize + InTailroom);
+        Offset = InHeadroom;
+        Length = InSize;
+    }
+
+    void Reallocate(size_t InHeadroom, size_t InTailroom)
+    {
+        std::shared_ptr<std::vector<uint8_t>> OldStorage = Storage;
+        size_t OldOffset = Offset;
+
+        Allocate(Length, InHeadroom, InTailroom);
+        if (Length > 0)
+        {
+            memcpy(Data(), OldStorage->data() + OldOffset, Length);
+        }
+    }
+
+private:
+    std::shared_ptr<std::vector<uint8_t>> Storage;
+    size_t Offset = 0;
+    size_t Length = 0;
+
+};
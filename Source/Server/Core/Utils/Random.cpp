@@ -10,29 +10,156 @@
 #include "Core/Utils/Random.h"
 
 #include <random>
+#include <cstring>
 
-void FillRandomBytes(std::vector<uint8_t>& Output)
+namespace 
 {
-	static std::random_device device;
-	static std::mt19937 generator(device());
+    inline uint32_t RotateLeft(uint32_t Value, int Count)
+    {
+        return (Value << Count) | (Value >> (32 - Count));
+    }
 
-	std::uniform_int_distribution<> distribution(0, 255);
+    inline void QuarterRound(uint32_t* X, int A, int B, int C, int D)
+    {
+        X[A] += X[B]; X[D] = RotateLeft(X[D] ^ X[A], 16);
+        X[C] += X[D]; X[B] = RotateLeft(X[B] ^ X[C], 12);
+        X[A] += X[B]; X[D] = RotateLeft(X[D] ^ X[A], 8);
+        X[C] += X[D]; X[B] = RotateLeft(X[B] ^ X[C], 7);
+    }
 
-	for (size_t i = 0; i < Output.size(); i++)
-	{
-		Output[i] = distribution(generator);
-	}
-}
+    // Standard ChaCha20 block function (RFC 8439), writes 64 bytes of keystream.
+    void ChaChaBlock(const uint32_t* Input, uint8_t* Output)
+    {
+        uint32_t X[16];
+        memcpy(X, Input, sizeof(X));
 
-void FillRandomBytes(uint8_t* Buffer, int Count)
-{
-	static std::random_device device;
-	static std::mt19937 generator(device());
+        for (int i = 0; i < 10; i++)
+        {
+            QuarterRound(X, 0, 4, 8, 12);
+            QuarterRound(X, 1, 5, 9, 13);
+            QuarterRound(X, 2, 6, 10, 14);
+            QuarterRound(X, 3, 7, 11, 15);
+            QuarterRound(X, 0, 5, 10, 15);
+            QuarterRound(X, 1, 6, 11, 12);
+            QuarterRound(X, 2, 7, 8, 13);
+            QuarterRound(X, 3, 4, 9, 14);
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            uint32_t Word = X[i] + Input[i];
+            Output[i * 4 + 0] = (uint8_t)(Word);
+            Output[i * 4 + 1] = (uint8_t)(Word >> 8);
+            Output[i * 4 + 2] = (uint8_t)(Word >> 16);
+            Output[i * 4 + 3] = (uint8_t)(Word >> 24);
+        }
+    }
+
+    // Buffered ChaCha20 keystream generator. Each refill generates a batch of blocks under 
+    // the current key, then replaces the key with the first 32 bytes of that batch (which 
+    // are never handed out). Bytes are wiped from the buffer once handed out, so neither
+    // the key nor the buffer can be used to recover earlier output.
+    class ChaChaGenerator
+    {
+    public:
+        ~ChaChaGenerator()
+        {
+            memset(Key, 0, sizeof(Key));
+            memset(Buffer, 0, sizeof(Buffer));
+        }
+
+        void Fill(uint8_t* Output, size_t Count)
+        {
+            while (Count > 0)
+            {
+                if (Available == 0)
+                {
+                    Refill();
+                }
+
+                size_t ChunkSize = Count < Available ? Count : Available;
+                uint8_t* Source = Buffer + sizeof(Buffer) - Available;
+
+                memcpy(Output, Source, ChunkSize);
+                memset(Source, 0, ChunkSize);
+
+                Output += ChunkSize;
+                Count -= ChunkSize;
+                Available -= ChunkSize;
+            }
+        }
+
+    private:
+        // Mixes fresh os entropy into the key. std::random_device is backed by the 
+        // os's cryptographic generator on all the platforms we build for.
+        void Reseed()
+        {
+            std::random_device Device;
+            for (size_t i = 0; i < KEY_WORDS; i++)
+            {
+                Key[i] ^= Device();
+            }
+
+            BytesSinceReseed = 0;
+            bSeeded = true;
+        }
+
+        void Refill()
+        {
+            if (!bSeeded || BytesSinceReseed >= RESEED_INTERVAL)
+            {
+                Reseed();
+            }
+
+            uint32_t State[16] = {
+                0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                Key[0], Key[1], Key[2], Key[3], Key[4], Key[5], Key[6], Key[7],
+                0, 0, 0, 0
+            };
 
-	std::uniform_int_distribution<> distribution(0, 255);
+            for (size_t i = 0; i < BUFFER_BLOCKS; i++)
+            {
+                State[12] = (uint32_t)i;
+                ChaChaBlock(State, Buffer + i * BLOCK_SIZE);
+            }
+            memset(State, 0, sizeof(State));
 
-	for (size_t i = 0; i < Count; i++)
-	{
-		Buffer[i] = distribution(generator);
-	}
-}
\ No newline at end of file
+            for (size_t i = 0; i < KEY_WORDS; i++)
+            {
+                const uint8_t* Bytes = Buffer + i * 4;
+                Key[i] = (uint32_t)Bytes[0] | ((uint32_t)Bytes[1] << 8) | ((uint32_t)Bytes[2] << 16) | ((uint32_t)Bytes[3] << 24);
+            }
+            memset(Buffer, 0, KEY_WORDS * 4);
+
+            Available = sizeof(Buffer) - KEY_WORDS * 4;
+            BytesSinceReseed += Available;
+        }
+
+    private:
+        static inline const size_t BLOCK_SIZE = 64;
+        static inline const size_t BUFFER_BLOCKS = 16;
+        static inline const size_t KEY_WORDS = 8;
+
+        // How much output we generate before mixing in more os entropy.
+        static inline const size_t RESEED_INTERVAL = 1024 * 1024;
+
+        uint32_t Key[KEY_WORDS] = {};
+        uint8_t Buffer[BUFFER_BLOCKS * BLOCK_SIZE] = {};
+        size_t Available = 0;
+        size_t BytesSinceReseed = 0;
+        bool bSeeded = false;
+
+    };
+
+    thread_local ChaChaGenerator Generator;
+};
+
+void FillRandomBytes(std::vector<uint8_t>& Output)
+{
+    Generator.Fill(Output.data(), Output.size());
+}
+
+void FillRandomBytes(uint8_t* Buffer, size_t Count)
+{
+    Generator.Fill(Buffer, Count);
+}
@@ -11,8 +11,16 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 // Some general purpose random functionality.
+//
+// Random bytes come from a per-thread ChaCha20 generator seeded (and periodically 
+// reseeded) from the os entropy source. Output is generated a block at a time into 
+// a buffer, so small requests like per-packet IV's are normally just a memcpy. 
+// It's suitable for keys, IV's and auth tokens, and is safe to call from any thread.
 
 void FillRandomBytes(std::vector<uint8_t>& Output);
-void FillRandomBytes(uint8_t* Buffer, int Count);
\ No newline at end of file
+void FillRandomBytes(uint8_t* Buffer, size_t Count);
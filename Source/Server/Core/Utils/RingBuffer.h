@@ -0,0 +1,153 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+// This file contains a simple fixed capacity FIFO ring buffer.
+//
+// All slots are allocated up front and reused for the lifetime of the buffer.
+// Popped values are not replaced, instead ElementType::Reset is called on them,
+// which should empty the value while keeping any storage it can reuse.
+//
+// Values can optionally be pushed with a sequence number, in which case the
+// value for a sequence number is always held in slot (sequence % capacity) and 
+// can be looked up directly with FindSequence. Sequence numbers pushed this way must 
+// be consecutive, and if they wrap the capacity must divide the range they wrap at.
+//
+// You can use it roughly like this:
+//
+//   RingBuffer<Packet> Queue(128);
+//   Queue.PushBack(Packet);
+//   Packet& Next = Queue.Front();
+//   Queue.PopFront();
+//
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+template <typename ElementType>
+class RingBuffer
+{
+public:
+    RingBuffer(size_t InCapacity = 0)
+        : Slots(InCapacity)
+        , SlotSequences(InCapacity, NoSequence)
+    {
+    }
+
+    size_t Size() const     { return Count; }
+    size_t Capacity() const { return Slots.size(); }
+    bool Empty() const      { return Count == 0; }
+    bool Full() const       { return Count == Slots.size(); }
+
+    // Returns false if the buffer is full.
+    bool PushBack(const ElementType& Value)
+    {
+        if (Full())
+        {
+            return false;
+        }
+
+        size_t Slot = (Head + Count) % Slots.size();
+        Slots[Slot] = Value;
+        SlotSequences[Slot] = NoSequence;
+        Count++;
+
+        return true;
+    }
+
+    bool PushBack(ElementType&& Value)
+    {
+        if (Full())
+        {
+            return false;
+        }
+
+        size_t Slot = (Head + Count) % Slots.size();
+        Slots[Slot] = std::move(Value);
+        SlotSequences[Slot] = NoSequence;
+        Count++;
+
+        return true;
+    }
+
+    // Pushes a value that must be found again by its sequence number. Sequence must 
+    // follow on from the last value pushed, if the buffer is empty the front is moved
+    // to the sequences slot. Returns false if the buffer is full.
+    bool PushBack(size_t Sequence, ElementType&& Value)
+    {
+        if (Empty())
+        {
+            Head = Sequence % Slots.size();
+        }
+
+        if (!PushBack(std::move(Value)))
+        {
+            return false;
+        }
+
+        SlotSequences[(Head + Count - 1) % Slots.size()] = Sequence;
+        return true;
+    }
+
+    void PopFront()
+    {
+        Slots[Head].Reset();
+        SlotSequences[Head] = NoSequence;
+        Head = (Head + 1) % Slots.size();
+        Count--;
+    }
+
+    ElementType& Front()                    { return Slots[Head]; }
+    ElementType& Back()                     { return Slots[(Head + Count - 1) % Slots.size()]; }
+
+    // Index is relative to the front of the buffer.
+    ElementType& operator[](size_t Index)   { return Slots[(Head + Index) % Slots.size()]; }
+
+    // Returns the value pushed with the given sequence number, or nullptr if it's no 
+    // longer (or was never) in the buffer.
+    ElementType* FindSequence(size_t Sequence)
+    {
+        if (Slots.empty())
+        {
+            return nullptr;
+        }
+
+        size_t Slot = Sequence % Slots.size();
+        size_t Index = (Slot + Slots.size() - Head) % Slots.size();
+        if (Index >= Count || SlotSequences[Slot] != Sequence)
+        {
+            return nullptr;
+        }
+
+        return &Slots[Slot];
+    }
+
+    void Clear()
+    {
+        while (!Empty())
+        {
+            PopFront();
+        }
+        Head = 0;
+    }
+
+private:
+    inline static const size_t NoSequence = ~(size_t)0;
+
+    std::vector<ElementType> Slots;
+
+    // Sequence number each slot was pushed with, or NoSequence.
+    std::vector<size_t> SlotSequences;
+
+    size_t Head = 0;
+    size_t Count = 0;
+
+};
@@ -0,0 +1,165 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Utils/TimerWheel.h"
+#include "Platform/Platform.h"
+
+#include <cmath>
+#include <limits>
+
+TimerWheel::TimerWheel(double InResolution)
+    : Resolution(InResolution)
+{
+    CurrentTick = TimeToTick(GetSeconds());
+}
+
+uint64_t TimerWheel::TimeToTick(double Time)
+{
+    if (Time <= 0.0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::floor(Time / Resolution));
+}
+
+TimerWheel::Handle TimerWheel::Schedule(double Deadline, Callback InCallback)
+{
+    Handle TimerHandle = NextHandle++;
+
+    // Round up so timers never fire early, anything already due fires on the next tick.
+    uint64_t DeadlineTick = TimeToTick(Deadline);
+    if (DeadlineTick * Resolution < Deadline)
+    {
+        DeadlineTick++;
+    }
+    if (DeadlineTick <= CurrentTick)
+    {
+        DeadlineTick = CurrentTick + 1;
+    }
+    else if (DeadlineTick - CurrentTick > MAX_TICKS)
+    {
+        DeadlineTick = CurrentTick + MAX_TICKS;
+    }
+
+    Timers[TimerHandle] = { DeadlineTick, std::move(InCallback) };
+    Insert(TimerHandle, DeadlineTick);
+
+    return TimerHandle;
+}
+
+bool TimerWheel::Cancel(Handle TimerHandle)
+{
+    return Timers.erase(TimerHandle) > 0;
+}
+
+void TimerWheel::Insert(Handle TimerHandle, uint64_t DeadlineTick)
+{
+    uint64_t Delta = DeadlineTick - CurrentTick;
+
+    // Find the finest level that can represent the deadline. Each level covers
+    // 64 times the range of the previous.
+    size_t Level = 0;
+    while (Level < LEVEL_COUNT - 1 && Delta >= (1ull << (LEVEL_BITS * (Level + 1))))
+    {
+        Level++;
+    }
+
+    size_t Slot = (DeadlineTick >> (LEVEL_BITS * Level)) & SLOT_MASK;
+    Levels[Level][Slot].push_back(TimerHandle);
+}
+
+void TimerWheel::Cascade(size_t Level)
+{
+    size_t Slot = (CurrentTick >> (LEVEL_BITS * Level)) & SLOT_MASK;
+
+    std::vector<Handle> Handles;
+    Handles.swap(Levels[Level][Slot]);
+
+    for (Handle TimerHandle : Handles)
+    {
+        if (auto iter = Timers.find(TimerHandle); iter != Timers.end())
+        {
+            Insert(TimerHandle, iter->second.DeadlineTick);
+        }
+    }
+}
+
+void TimerWheel::Advance(double Time)
+{
+    uint64_t TargetTick = TimeToTick(Time);
+
+    std::vector<Handle> Expired;
+    std::vector<Callback> Callbacks;
+
+    while (CurrentTick < TargetTick)
+    {
+        // Nothing scheduled, just jump straight to the target.
+        if (Timers.empty())
+        {
+            CurrentTick = TargetTick;
+            break;
+        }
+
+        CurrentTick++;
+
+        // When a level wraps around, pull the next slot of the level above
+        // it down. Do the coarsest levels first so their timers can continue
+        // cascading into the finer levels this tick.
+        size_t CascadeLevels = 0;
+        while (CascadeLevels < LEVEL_COUNT - 1 && ((CurrentTick >> (LEVEL_BITS * CascadeLevels)) & SLOT_MASK) == 0)
+        {
+            CascadeLevels++;
+        }
+        for (size_t Level = CascadeLevels; Level > 0; Level--)
+        {
+            Cascade(Level);
+        }
+
+        Expired.clear();
+        Expired.swap(Levels[0][CurrentTick & SLOT_MASK]);
+
+        // Grab all the callbacks before running any, callbacks are free to schedule
+        // new timers which may end up in the slot we are processing.
+        Callbacks.clear();
+        for (Handle TimerHandle : Expired)
+        {
+            if (auto iter = Timers.find(TimerHandle); iter != Timers.end())
+            {
+                Callbacks.push_back(std::move(iter->second.Function));
+                Timers.erase(iter);
+            }
+        }
+
+        for (Callback& Function : Callbacks)
+        {
+            Function();
+        }
+    }
+}
+
+double TimerWheel::GetNextDeadline()
+{
+    if (Timers.empty())
+    {
+        return std::numeric_limits<double>::max();
+    }
+
+    // Check for anything due in the first level.
+    for (uint64_t Tick = CurrentTick + 1; Tick <= CurrentTick + SLOTS_PER_LEVEL; Tick++)
+    {
+        if (!Levels[0][Tick & SLOT_MASK].empty())
+        {
+            return Tick * Resolution;
+        }
+    }
+
+    // Otherwise nothing is going to happen until the next cascade.
+    uint64_t NextCascadeTick = (CurrentTick | SLOT_MASK) + 1;
+    return NextCascadeTick * Resolution;
+}
@@ -0,0 +1,94 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "Config/BuildConfig.h"
+
+// Hierarchical timer wheel used to track large numbers of deadlines (client timeouts,
+// token expiry, retransmits, etc) without having to scan all of them every tick. The
+// cost of advancing the wheel is proportional to the number of timers that expire
+// rather than the number that are scheduled.
+//
+// Time is split into ticks of a fixed resolution. Timers due within the next 64 ticks
+// live in the first level, those further out live in coarser levels and are cascaded
+// down as the wheel turns. Deadlines beyond the range of the wheel are clamped to
+// the furthest point it can represent, so callers with very long timeouts should
+// check if they have actually expired when fired and reschedule if not.
+//
+// Timer wheels are not thread safe, each one should be owned by a single thread
+// (or only be accessed while holding its owners lock). Callbacks are run from
+// inside Advance.
+
+class TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+    using Handle = uint64_t;
+
+    static inline const Handle InvalidHandle = 0;
+
+public:
+    TimerWheel(double InResolution = BuildConfig::TIMER_WHEEL_RESOLUTION);
+
+    // Schedules the callback to be run when Advance passes the given
+    // deadline (as returned by GetSeconds).
+    Handle Schedule(double Deadline, Callback InCallback);
+
+    // Stops a timer from firing. Returns false if the timer has already fired
+    // or been cancelled.
+    bool Cancel(Handle TimerHandle);
+
+    // Moves the wheel forward to the given time, running the callbacks of
+    // any timers that have expired.
+    void Advance(double Time);
+
+    // Gets the earliest time at which Advance may have timers to run. This is
+    // approximate, it may be earlier than the next timer but will never be later.
+    double GetNextDeadline();
+
+    // Gets the number of timers that are currently scheduled.
+    size_t GetCount() { return Timers.size(); }
+
+private:
+    void Insert(Handle TimerHandle, uint64_t DeadlineTick);
+    void Cascade(size_t Level);
+
+    uint64_t TimeToTick(double Time);
+
+private:
+    static inline const size_t LEVEL_BITS = 6;
+    static inline const size_t SLOTS_PER_LEVEL = 1 << LEVEL_BITS;
+    static inline const size_t SLOT_MASK = SLOTS_PER_LEVEL - 1;
+    static inline const size_t LEVEL_COUNT = 4;
+    static inline const uint64_t MAX_TICKS = (1ull << (LEVEL_BITS * LEVEL_COUNT)) - 1;
+
+    struct Timer
+    {
+        uint64_t DeadlineTick;
+        Callback Function;
+    };
+
+    double Resolution;
+    uint64_t CurrentTick = 0;
+    Handle NextHandle = 1;
+
+    // Slots only hold handles, cancelled timers are just removed from Timers and
+    // skipped over when their slot is processed.
+    std::array<std::array<std::vector<Handle>, SLOTS_PER_LEVEL>, LEVEL_COUNT> Levels;
+
+    std::unordered_map<Handle, Timer> Timers;
+
+};
@@ -0,0 +1,105 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Core/Utils/WorkerPool.h"
+
+WorkerPool::~WorkerPool()
+{
+    Term();
+}
+
+bool WorkerPool::Init(size_t ThreadCount)
+{
+    if (ThreadCount == 0)
+    {
+        ThreadCount = 1;
+    }
+
+    bQuitting = false;
+
+    for (size_t i = 0; i < ThreadCount; i++)
+    {
+        Threads.push_back(std::thread([this]() {
+            Run();
+        }));
+    }
+
+    return true;
+}
+
+void WorkerPool::Term()
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        bQuitting = true;
+    }
+    QueueCondition.notify_all();
+
+    for (std::thread& Thread : Threads)
+    {
+        if (Thread.joinable())
+        {
+            Thread.join();
+        }
+    }
+    Threads.clear();
+}
+
+void WorkerPool::Submit(Task InTask)
+{
+    {
+        std::unique_lock<std::mutex> Lock(QueueMutex);
+        Queue.push_back(std::move(InTask));
+
+        if (Queue.size() > PeakQueueDepth)
+        {
+            PeakQueueDepth = Queue.size();
+        }
+    }
+    QueueCondition.notify_one();
+}
+
+size_t WorkerPool::GetQueueDepth()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    return Queue.size();
+}
+
+size_t WorkerPool::GetPeakQueueDepth()
+{
+    std::unique_lock<std::mutex> Lock(QueueMutex);
+    return PeakQueueDepth;
+}
+
+void WorkerPool::Run()
+{
+    while (true)
+    {
+        Task NextTask;
+
+        {
+            std::unique_lock<std::mutex> Lock(QueueMutex);
+            QueueCondition.wait(Lock, [this]() { 
+                return bQuitting || !Queue.empty(); 
+            });
+
+            // Drain anything left in the queue before quitting, tasks may be 
+            // holding onto things that expect them to run.
+            if (Queue.empty())
+            {
+                return;
+            }
+
+            NextTask = std::move(Queue.front());
+            Queue.pop_front();
+        }
+
+        NextTask();
+    }
+}
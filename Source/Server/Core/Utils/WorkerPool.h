@@ -0,0 +1,66 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Small fixed size pool of threads that runs tasks in the order they are submitted. 
+// Used to get expensive work (eg. rsa decryption) off the main loop. Tasks are 
+// responsible for getting their results back to whoever is waiting on them.
+//
+// You can use it roughly like this:
+//
+//   WorkerPool Pool;
+//   Pool.Init(4);
+//   Pool.Submit([]() { DoSomethingSlow(); });
+//   ...
+//   Pool.Term();
+//
+
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+
+public:
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    bool Init(size_t ThreadCount);
+
+    // Waits for all queued tasks to finish and then stops the threads.
+    void Term();
+
+    // Queues a task to run on one of the worker threads. Safe to call from any thread.
+    void Submit(Task InTask);
+
+    // Number of tasks waiting for a thread to run them, and the 
+    // most there has been at once.
+    size_t GetQueueDepth();
+    size_t GetPeakQueueDepth();
+
+private:
+    void Run();
+
+private:
+    std::vector<std::thread> Threads;
+
+    std::mutex QueueMutex;
+    std::condition_variable QueueCondition;
+    std::deque<Task> Queue;
+    size_t PeakQueueDepth = 0;
+    bool bQuitting = false;
+
+};
@@ -9,6 +9,7 @@
 
 #include "Server/Server.h"
 #include "Client/Client.h"
+#include "Core/Crypto/CWCBenchmark.h"
 #include "Core/Utils/Logging.h"
 #include "Platform/Platform.h"
 
@@ -53,6 +54,14 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // Benchmarks don't need steam, so run them before its initialized.
+    if (mode_arg == "-benchmark_cwc")
+    {
+        bool bSuccess = RunCWCBenchmark();
+        PlatformTerm();
+        return bSuccess ? 0 : 1;
+    }
+
     if (start_as_client_emulator)
     {
         if (!SteamAPI_Init())
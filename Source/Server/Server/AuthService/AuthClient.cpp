@@ -26,19 +26,21 @@
 #include "Config/RuntimeConfig.h"
 
 #include "Core/Crypto/CWCCipher.h"
+#include "Core/Crypto/Cipher.h"
 
 #include "Protobuf/Protobufs.h"
 
-#include <steam/steam_api.h>
-#include <steam/steam_gameserver.h>
-
 AuthClient::AuthClient(AuthService* OwningService, std::shared_ptr<NetConnection> InConnection, RSAKeyPair* InServerRSAKey)
     : Service(OwningService)
     , Connection(InConnection)
 {
     LastMessageRecievedTime = GetSeconds();
+    ConnectTime = LastMessageRecievedTime;
 
     MessageStream = std::make_shared<Frpg2MessageStream>(InConnection, InServerRSAKey);
+
+    HandshakeCipher = MessageStream->GetDecryptionCipher();
+    MessageStream->SetCipher(MessageStream->GetEncryptionCipher(), nullptr);
 }
 
 bool AuthClient::Poll()
@@ -84,9 +86,37 @@ bool AuthClient::Poll()
                     return true;
                 }
 
+                // The request is rsa encrypted, which is slow enough that we don't want 
+                // to do it on the main thread when lots of clients are connecting.
+                PendingJob = std::make_shared<AuthClientJob>();
+                PendingMessageIndex = Message.Header.msg_index;
+
+                Service->RunAsync(PendingJob, [Decryptor = HandshakeCipher, Payload = std::move(Message.Payload)](AuthClientJob& Job) {
+                    Job.bSuccess = Payload.empty() || Decryptor->Decrypt(Payload, Job.Output);
+                });
+
+                LastMessageRecievedTime = GetSeconds();
+                State = AuthClientState::WaitingForHandshakeDecryption;
+            }
+
+            break;
+        }
+
+    // Waiting for a worker to decrypt the handshake request.
+    case AuthClientState::WaitingForHandshakeDecryption:
+        {
+            if (PendingJob->bComplete.load(std::memory_order_acquire))
+            {
+                std::shared_ptr<AuthClientJob> Job = std::move(PendingJob);
+                if (!Job->bSuccess)
+                {
+                    WarningS(GetName().c_str(), "Disconnecting client as failed to decrypt RequestHandshake.");
+                    return true;
+                }
+
                 // First request is always the handshake request. 
                 Frpg2RequestMessage::RequestHandshake Request;
-                if (!Request.ParseFromArray(Message.Payload.data(), (int)Message.Payload.size()))
+                if (!Request.ParseFromArray(Job->Output.data(), (int)Job->Output.size()))
                 {
                     WarningS(GetName().c_str(), "Disconnecting client as recieved unexpected message, expecting RequestHandshake.");
                     return true;
@@ -108,7 +138,7 @@ bool AuthClient::Poll()
                 FillRandomBytes(Response.Payload);
                 memset(Response.Payload.data() + 11, 0, 16);
 
-                if (!MessageStream->Send(Response, Frpg2MessageType::Reply, Message.Header.msg_index))
+                if (!MessageStream->Send(Response, Frpg2MessageType::Reply, PendingMessageIndex))
                 {
                     WarningS(GetName().c_str(), "Disconnecting client as failed to send cipher validation response.");
                     return true;
@@ -214,9 +244,6 @@ bool AuthClient::Poll()
             Frpg2Message Message;
             if (MessageStream->Recieve(&Message))
             {
-                const RuntimeConfig& RuntimeConfig = Service->GetServer()->GetConfig();
-                std::string ServerIP = Service->GetServer()->GetPublicIP().ToString();
-
                 // Format Note:
                 // The message payload is stored as:
                 //      Bytes 0-15: GameCwcKey Calculated Above
@@ -227,26 +254,34 @@ bool AuthClient::Poll()
                     WarningS(GetName().c_str(), "Disconnecting client as recieved unexpected packet type while expected steam ticket.");
                     return true;
                 }
+                if (Message.Payload.size() < 16)
+                {
+                    WarningS(GetName().c_str(), "Disconnecting client as steam ticket payload was smaller than expected.");
+                    return true;
+                }
 
-                // Validate the steam ticket.
+                // Validated here rather than on a worker, the steam api isn't thread safe and its 
+                // callbacks are run on this thread. BeginAuthSession only checks the ticket locally
+                // (steam's verdict arrives later through a callback) so it's cheap to do inline.
                 std::vector<uint8_t> Ticket;
                 Ticket.assign(Message.Payload.data() + 16, Message.Payload.data() + 16 + (Message.Payload.size() - 16));
 
-                uint64 SteamIdInt;
+                unsigned long long SteamIdInt = 0;
                 sscanf(SteamId.c_str(), "%016llx", &SteamIdInt);
-                CSteamID SteamIdStruct(SteamIdInt);                
 
-                int AuthResult = SteamGameServer()->BeginAuthSession(Ticket.data(), (int)Ticket.size(), SteamIdStruct);
-                if (AuthResult != k_EBeginAuthSessionResultOK)
+                int ResultCode = 0;
+                if (!Service->GetTicketValidator().Validate(SteamIdInt, Ticket, ResultCode))
                 {
-                    WarningS(GetName().c_str(), "Disconnecting client as steam ticket authentication failed with error %i.", AuthResult);
+                    WarningS(GetName().c_str(), "Disconnecting client as steam ticket authentication failed with error %i.", ResultCode);
                     return true;
                 }
                 else
                 {
                     LogS(GetName().c_str(), "Client steam ticket authenticated successfully.");
                 }
-                SteamGameServer()->EndAuthSession(SteamIdStruct);
+
+                const RuntimeConfig& RuntimeConfig = Service->GetServer()->GetConfig();
+                std::string ServerIP = Service->GetServer()->GetPublicIP().ToString();
 
                 // If user IP is on a private network, we can assume they are on our LAN
                 // and return our internal IP address.
@@ -280,6 +315,8 @@ bool AuthClient::Poll()
 
                 LastMessageRecievedTime = GetSeconds();
 
+                Service->RecordHandshakeComplete(LastMessageRecievedTime - ConnectTime);
+
                 LogS(GetName().c_str(), "Authentication complete.");
                 State = AuthClientState::Complete;
             }
@@ -297,6 +334,11 @@ bool AuthClient::Poll()
     return false;
 }
 
+double AuthClient::GetTimeoutTime()
+{
+    return LastMessageRecievedTime + BuildConfig::CLIENT_TIMEOUT;
+}
+
 std::string AuthClient::GetName()
 {
     return Connection->GetName();
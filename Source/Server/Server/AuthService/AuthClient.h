@@ -20,6 +20,8 @@ class NetConnection;
 class Frpg2PacketStream;
 class Frpg2MessageStream;
 class RSAKeyPair;
+class Cipher;
+struct AuthClientJob;
 
 // Response data sent in as part of the authentication flow. No idea
 // why they didn't just use a protobuf for this.
@@ -72,6 +74,7 @@ static_assert(sizeof(Frpg2GameServerInfo) == 184, "Frpg2GameServerInfo is not ex
 enum class AuthClientState
 {
     WaitingForHandshakeRequest,
+    WaitingForHandshakeDecryption,
     WaitingForServiceStatusRequest,
     WaitingForKeyData,
     WaitingForSteamTicket,
@@ -87,6 +90,9 @@ public:
     // If this returns true the client is expected to be disconnected and is disposed of.
     bool Poll();
 
+    // Time at which the client will time out if it doesn't send anything else.
+    double GetTimeoutTime();
+
     std::string GetName();
 
 private:    
@@ -96,6 +102,16 @@ private:
     std::shared_ptr<Frpg2MessageStream> MessageStream;
 
     double LastMessageRecievedTime = 0.0;
+    double ConnectTime = 0.0;
+
+    // Rsa cipher the handshake request is encrypted with. We decrypt it ourselves on
+    // a worker thread rather than letting the message stream do it on the main thread.
+    std::shared_ptr<Cipher> HandshakeCipher;
+
+    // Work being done for us on the auth services worker threads, and the
+    // index of the message we need to reply to once its done.
+    std::shared_ptr<AuthClientJob> PendingJob;
+    uint32_t PendingMessageIndex = 0;
 
     std::vector<uint8_t> CwcKey;
     std::vector<uint8_t> GameCwcKey;
@@ -14,6 +14,7 @@
 
 #include "Core/Network/NetConnection.h"
 #include "Core/Network/NetConnectionTCP.h"
+#include "Core/Network/NetEventLoop.h"
 #include "Core/Utils/Logging.h"
 
 #include "Config/BuildConfig.h"
@@ -38,6 +39,23 @@ bool AuthService::Init()
         Error("Auth service failed to listen on port %i.", Port);
         return false;
     }
+    Connection->SetEventLoop(&ServerInstance->GetEventLoop());
+
+    if (ServerInstance->GetConfig().AuthServerSkipSteamValidation)
+    {
+        Warning("Steam tickets are not being validated, this should only be used for local testing.");
+        TicketValidator = std::make_unique<StubAuthTicketValidator>();
+    }
+    else
+    {
+        TicketValidator = std::make_unique<SteamAuthTicketValidator>();
+    }
+
+    if (!Workers.Init(ServerInstance->GetConfig().AuthServerWorkerCount))
+    {
+        Error("Auth service failed to start worker threads.");
+        return false;
+    }
 
     Log("Auth service is now listening on port %i.", Port);
 
@@ -46,9 +64,52 @@ bool AuthService::Init()
 
 bool AuthService::Term()
 {
+    // Jobs may still be referencing our state, make sure they are done with it.
+    Workers.Term();
+
     return true;
 }
 
+void AuthService::RunAsync(std::shared_ptr<AuthClientJob> Job, std::function<void(AuthClientJob&)> Work)
+{
+    NetEventLoop* EventLoop = &ServerInstance->GetEventLoop();
+
+    Workers.Submit([Job, Work = std::move(Work), EventLoop]() {
+        Work(*Job);
+        Job->bComplete.store(true, std::memory_order_release);
+        EventLoop->Wake();
+    });
+}
+
+void AuthService::RecordHandshakeComplete(double Duration)
+{
+    std::scoped_lock Lock(StatisticsMutex);
+
+    HandshakesCompleted++;
+    TotalHandshakeTime += Duration;
+    if (Duration > PeakHandshakeTime)
+    {
+        PeakHandshakeTime = Duration;
+    }
+}
+
+AuthServiceStatistics AuthService::GetStatistics()
+{
+    AuthServiceStatistics Result;
+
+    {
+        std::scoped_lock Lock(StatisticsMutex);
+        Result.HandshakesCompleted = HandshakesCompleted;
+        Result.AverageHandshakeTime = HandshakesCompleted > 0 ? TotalHandshakeTime / HandshakesCompleted : 0.0;
+        Result.PeakHandshakeTime = PeakHandshakeTime;
+    }
+
+    Result.WorkerQueueDepth = Workers.GetQueueDepth();
+    Result.PeakWorkerQueueDepth = Workers.GetPeakQueueDepth();
+
+    return Result;
+}
+
 void AuthService::Poll()
 {
     Connection->Pump();
@@ -81,6 +142,23 @@ void AuthService::HandleClientConnection(std::shared_ptr<NetConnection> ClientCo
     Clients.push_back(Client);
 }
 
+double AuthService::GetNextPollTime()
+{
+    // Clients sockets wake us when they have data to recieve or queued data can be sent,
+    // so the only thing we need to wake up for ourselves is the next client timing out.
+    double NextPollTime = GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+    for (auto& Client : Clients)
+    {
+        double TimeoutTime = Client->GetTimeoutTime();
+        if (TimeoutTime < NextPollTime)
+        {
+            NextPollTime = TimeoutTime;
+        }
+    }
+
+    return NextPollTime;
+}
+
 std::string AuthService::GetName()
 {
     return "Auth";
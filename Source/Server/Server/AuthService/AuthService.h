@@ -10,9 +10,15 @@
 #pragma once
 
 #include "Server/Service.h"
+#include "Server/AuthService/AuthTicketValidator.h"
+
+#include "Core/Utils/WorkerPool.h"
 
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <functional>
 
 class Server;
 class AuthClient;
@@ -20,6 +26,24 @@ class NetConnection;
 class NetConnectionTCP;
 class RSAKeyPair;
 
+// Work the auth service runs on its worker threads on behalf of a client. The
+// client polls bComplete, the other fields are only valid once its set.
+struct AuthClientJob
+{
+    std::atomic<bool> bComplete = false;
+    bool bSuccess = false;
+    std::vector<uint8_t> Output;
+};
+
+struct AuthServiceStatistics
+{
+    size_t HandshakesCompleted = 0;
+    double AverageHandshakeTime = 0.0;
+    double PeakHandshakeTime = 0.0;
+    size_t WorkerQueueDepth = 0;
+    size_t PeakWorkerQueueDepth = 0;
+};
+
 // The auth service is accessed by the client from an ip:port provided by 
 // the login service. The purpose of the auth service is to calculate a shared
 // secret key which will be used for all future communications, as well as 
@@ -35,11 +59,26 @@ public:
     virtual bool Init() override;
     virtual bool Term() override;
     virtual void Poll() override;
+    virtual double GetNextPollTime() override;
 
     virtual std::string GetName() override;
 
     Server* GetServer() { return ServerInstance; }
 
+    // Runs the work on one of the worker threads, marks the job as complete when
+    // its done and wakes the server so the waiting client gets polled.
+    void RunAsync(std::shared_ptr<AuthClientJob> Job, std::function<void(AuthClientJob&)> Work);
+
+    // Only use from the main thread, the steam api is not thread safe.
+    AuthTicketValidator& GetTicketValidator() { return *TicketValidator; }
+
+    // Called by clients when they finish authenticating, Duration is the time
+    // from connection to completion.
+    void RecordHandshakeComplete(double Duration);
+
+    // Safe to call from any thread.
+    AuthServiceStatistics GetStatistics();
+
 protected:
 
     void HandleClientConnection(std::shared_ptr<NetConnection> ClientConnection);
@@ -53,4 +92,12 @@ private:
 
     RSAKeyPair* ServerRSAKey;
 
+    WorkerPool Workers;
+    std::unique_ptr<AuthTicketValidator> TicketValidator;
+
+    std::mutex StatisticsMutex;
+    size_t HandshakesCompleted = 0;
+    double TotalHandshakeTime = 0.0;
+    double PeakHandshakeTime = 0.0;
+
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/AuthService/AuthTicketValidator.h"
+
+#include <steam/steam_api.h>
+#include <steam/steam_gameserver.h>
+
+bool SteamAuthTicketValidator::Validate(uint64_t SteamId, const std::vector<uint8_t>& Ticket, int& ResultCode)
+{
+    CSteamID SteamIdStruct(SteamId);
+
+    ResultCode = SteamGameServer()->BeginAuthSession(Ticket.data(), (int)Ticket.size(), SteamIdStruct);
+    if (ResultCode != k_EBeginAuthSessionResultOK)
+    {
+        return false;
+    }
+
+    SteamGameServer()->EndAuthSession(SteamIdStruct);
+    return true;
+}
+
+bool StubAuthTicketValidator::Validate(uint64_t SteamId, const std::vector<uint8_t>& Ticket, int& ResultCode)
+{
+    ResultCode = k_EBeginAuthSessionResultOK;
+    return !Ticket.empty();
+}
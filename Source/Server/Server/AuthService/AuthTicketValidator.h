@@ -0,0 +1,45 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Validates the steam authentication tickets clients send at the end of the auth flow.
+// Validate is called on the main thread, the same one that runs the steam callbacks.
+
+class AuthTicketValidator
+{
+public:
+    virtual ~AuthTicketValidator() = default;
+
+    // Returns true if the ticket is valid for the given steam id. ResultCode is set 
+    // to an implementation specific code describing why validation failed.
+    virtual bool Validate(uint64_t SteamId, const std::vector<uint8_t>& Ticket, int& ResultCode) = 0;
+};
+
+// Validates tickets using the steam game server api.
+class SteamAuthTicketValidator
+    : public AuthTicketValidator
+{
+public:
+    bool Validate(uint64_t SteamId, const std::vector<uint8_t>& Ticket, int& ResultCode) override;
+
+};
+
+// Accepts any ticket without talking to steam. Only intended for local testing (eg. running 
+// lots of emulated clients against a server), never use this on a public server.
+class StubAuthTicketValidator
+    : public AuthTicketValidator
+{
+public:
+    bool Validate(uint64_t SteamId, const std::vector<uint8_t>& Ticket, int& ResultCode) override;
+
+};
@@ -37,10 +37,14 @@ GameClient::GameClient(GameService* OwningService, std::shared_ptr<NetConnection
 }
 
 bool GameClient::Poll()
+{
+    return PollNetwork() || PollMessages();
+}
+
+bool GameClient::PollNetwork()
 {
     // Has this client timed out?
-    double TimeSinceLastMessage = GetSeconds() - LastMessageRecievedTime;
-    if (TimeSinceLastMessage >= BuildConfig::CLIENT_TIMEOUT)
+    if (TimedOut)
     {
         WarningS(GetName().c_str(), "Client timed out.");
         return true;
@@ -65,13 +69,18 @@ bool GameClient::Poll()
         return true;
     }
 
-    // Pump the message stream and handle any messages that come in.
+    // Pump the message stream, anything recieved is handled in PollMessages.
     if (MessageStream->Pump())
     {
         WarningS(GetName().c_str(), "Disconnecting client as message stream closed.");
         return true;
     }
 
+    return false;
+}
+
+bool GameClient::PollMessages()
+{
     // Process all packets.
     Frpg2ReliableUdpMessage Message;
     while (MessageStream->Recieve(&Message))
@@ -91,6 +100,10 @@ bool GameClient::Poll()
 
         // TODO: Find a better way to do this that doesn't break our abstraction.
         MessageStream->HandledPacket(Message.AckSequenceIndex);
+        MessagesHandled++;
+
+        // Hand the protobuf back to its pool now we are done with it.
+        Message.Protobuf.reset();
     }
 
     // Update lat recieved time.
@@ -102,27 +115,20 @@ bool GameClient::Poll()
     return false;
 }
 
-bool GameClient::HandleMessage(const Frpg2ReliableUdpMessage& Message)
+double GameClient::GetNextPollTime()
 {
-    const std::vector<std::shared_ptr<GameManager>>& Managers = Service->GetManagers();
-    for (auto& Manager : Managers)
+    double NextPollTime = MessageStream->GetNextPollTime();
+    if (DisconnectTime > 0.0 && DisconnectTime < NextPollTime)
     {
-        MessageHandleResult Result = Manager->OnMessageRecieved(this, Message);
-        if (Result == MessageHandleResult::Error)
-        {
-            return true;
-        }
-        else if (Result == MessageHandleResult::Handled)
-        {
-            return false;
-        }
-        else if (Result == MessageHandleResult::Unhandled)
-        {
-            // Continue;
-        }
+        NextPollTime = DisconnectTime;
     }
+    return NextPollTime;
+}
 
-    return true;
+bool GameClient::HandleMessage(const Frpg2ReliableUdpMessage& Message)
+{
+    MessageHandleResult Result = Service->GetMessageDispatcher().Dispatch(this, Message);
+    return Result != MessageHandleResult::Handled;
 }
 
 std::string GameClient::GetName()
@@ -152,4 +158,7 @@ void GameClient::SendTextMessage(const std::string& TextMessage)
     {
         WarningS(GetName().c_str(), "Failed to send game client text message.");
     }
+
+    // This is called from outside the shards poll, so make sure its woken up to send it.
+    Service->WakeShard(ShardIndex);
 }
\ No newline at end of file
@@ -30,15 +30,30 @@ class GameClient
 public:
     GameClient(GameService* OwningService, std::shared_ptr<NetConnection> InConnection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken);
 
+    // Index of the game service shard that owns this client.
+    size_t ShardIndex = 0;
+
     // If this returns true the client is expected to be disconnected and is disposed of.
     bool Poll();
 
+    // Poll is split into two halves so the game service can run the network side 
+    // (recieving, decrypting, reliability, etc) for different clients in parallel, 
+    // and only serialize the message handling that touches shared state.
+    // As with Poll, a return of true means the client should be disconnected.
+    bool PollNetwork();
+    bool PollMessages();
+
+    // Gets the time the client next needs polling if nothing is recieved before then.
+    double GetNextPollTime();
+
     std::string GetName();
 
     PlayerState& GetPlayerState() { return State; }
 
     double GetConnectionDuration() { return GetSeconds() - ConnectTime; }
 
+    double GetLastMessageRecievedTime() { return LastMessageRecievedTime; }
+
     // Sends a text message displayed at the top of the users screen.
     void SendTextMessage(const std::string& Message);
 
@@ -56,6 +71,13 @@ public:
 
     bool Banned = false;
 
+    // Set by the game service when the client has not sent us anything for CLIENT_TIMEOUT.
+    bool TimedOut = false;
+
+    // Total messages handled, lets the game service tell if polling this client may 
+    // have queued messages on clients belonging to other shards.
+    size_t MessagesHandled = 0;
+
 protected:
 
     bool HandleMessage(const Frpg2ReliableUdpMessage& Message);
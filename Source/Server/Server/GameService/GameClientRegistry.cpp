@@ -0,0 +1,166 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/GameService/GameClientRegistry.h"
+#include "Server/GameService/GameClient.h"
+#include "Server/GameService/PlayerState.h"
+
+#include <algorithm>
+
+namespace
+{
+    const GameClientRegistry::ClientList EmptyClientList;
+};
+
+template <typename KeyType>
+void GameClientRegistry::AddToIndex(ClientIndex<KeyType>& Index, const KeyType& Key, const std::shared_ptr<GameClient>& Client)
+{
+    Index[Key].push_back(Client);
+}
+
+template <typename KeyType>
+void GameClientRegistry::RemoveFromIndex(ClientIndex<KeyType>& Index, const KeyType& Key, const std::shared_ptr<GameClient>& Client)
+{
+    auto iter = Index.find(Key);
+    if (iter == Index.end())
+    {
+        return;
+    }
+
+    ClientList& List = iter->second;
+    List.erase(std::remove(List.begin(), List.end(), Client), List.end());
+
+    // Don't keep empty lists around for every id that has ever been seen.
+    if (List.empty())
+    {
+        Index.erase(iter);
+    }
+}
+
+template <typename KeyType>
+const GameClientRegistry::ClientList& GameClientRegistry::FindInIndex(const ClientIndex<KeyType>& Index, const KeyType& Key)
+{
+    if (auto iter = Index.find(Key); iter != Index.end())
+    {
+        return iter->second;
+    }
+    return EmptyClientList;
+}
+
+void GameClientRegistry::AddToIndexes(const IndexedValues& Values)
+{
+    AddToIndex(ByPlayerId, Values.PlayerId, Values.Client);
+    AddToIndex(BySteamId, Values.SteamId, Values.Client);
+    AddToIndex(ByArea, Values.Area, Values.Client);
+    AddToIndex(ByVisitorPool, Values.VisitorPool, Values.Client);
+}
+
+void GameClientRegistry::RemoveFromIndexes(const IndexedValues& Values)
+{
+    RemoveFromIndex(ByPlayerId, Values.PlayerId, Values.Client);
+    RemoveFromIndex(BySteamId, Values.SteamId, Values.Client);
+    RemoveFromIndex(ByArea, Values.Area, Values.Client);
+    RemoveFromIndex(ByVisitorPool, Values.VisitorPool, Values.Client);
+}
+
+void GameClientRegistry::Add(const std::shared_ptr<GameClient>& Client)
+{
+    if (Entries.count(Client.get()) > 0)
+    {
+        return;
+    }
+
+    PlayerState& State = Client->GetPlayerState();
+
+    IndexedValues Values;
+    Values.Client = Client;
+    Values.PlayerId = State.PlayerId;
+    Values.SteamId = State.SteamId;
+    Values.Area = State.CurrentArea;
+    Values.VisitorPool = State.VisitorPool;
+
+    AddToIndexes(Values);
+    Entries.emplace(Client.get(), std::move(Values));
+    Clients.push_back(Client);
+}
+
+void GameClientRegistry::Remove(const std::shared_ptr<GameClient>& Client)
+{
+    auto iter = Entries.find(Client.get());
+    if (iter == Entries.end())
+    {
+        return;
+    }
+
+    RemoveFromIndexes(iter->second);
+    Entries.erase(iter);
+    Clients.erase(std::remove(Clients.begin(), Clients.end(), Client), Clients.end());
+}
+
+void GameClientRegistry::Update(GameClient* Client)
+{
+    auto iter = Entries.find(Client);
+    if (iter == Entries.end())
+    {
+        return;
+    }
+
+    IndexedValues& Values = iter->second;
+    PlayerState& State = Client->GetPlayerState();
+
+    if (Values.PlayerId != State.PlayerId)
+    {
+        RemoveFromIndex(ByPlayerId, Values.PlayerId, Values.Client);
+        Values.PlayerId = State.PlayerId;
+        AddToIndex(ByPlayerId, Values.PlayerId, Values.Client);
+    }
+
+    if (Values.SteamId != State.SteamId)
+    {
+        RemoveFromIndex(BySteamId, Values.SteamId, Values.Client);
+        Values.SteamId = State.SteamId;
+        AddToIndex(BySteamId, Values.SteamId, Values.Client);
+    }
+
+    if (Values.Area != State.CurrentArea)
+    {
+        RemoveFromIndex(ByArea, Values.Area, Values.Client);
+        Values.Area = State.CurrentArea;
+        AddToIndex(ByArea, Values.Area, Values.Client);
+    }
+
+    if (Values.VisitorPool != State.VisitorPool)
+    {
+        RemoveFromIndex(ByVisitorPool, Values.VisitorPool, Values.Client);
+        Values.VisitorPool = State.VisitorPool;
+        AddToIndex(ByVisitorPool, Values.VisitorPool, Values.Client);
+    }
+}
+
+std::shared_ptr<GameClient> GameClientRegistry::FindByPlayerId(uint32_t PlayerId) const
+{
+    const ClientList& List = FindInIndex(ByPlayerId, PlayerId);
+    return List.empty() ? nullptr : List.front();
+}
+
+std::shared_ptr<GameClient> GameClientRegistry::FindBySteamId(const std::string& SteamId) const
+{
+    const ClientList& List = FindInIndex(BySteamId, SteamId);
+    return List.empty() ? nullptr : List.front();
+}
+
+const GameClientRegistry::ClientList& GameClientRegistry::GetClientsInArea(OnlineAreaId Area) const
+{
+    return FindInIndex(ByArea, Area);
+}
+
+const GameClientRegistry::ClientList& GameClientRegistry::GetClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool) const
+{
+    return FindInIndex(ByVisitorPool, Pool);
+}
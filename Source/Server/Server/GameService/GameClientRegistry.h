@@ -0,0 +1,96 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "Protobuf/Protobufs.h"
+
+#include "Server/GameService/Utils/GameIds.h"
+
+class GameClient;
+
+// Holds all the clients connected to the game service, indexed by the parts of their
+// player state that managers most often search on (player id, steam id, area and
+// visitor pool). This means matchmaking, push notifications and the like only have
+// to look at the clients they are interested in rather than scanning everyone.
+//
+// The indexes are built from each clients PlayerState, anything that changes one of
+// the indexed values needs to call Update afterwards to move the client to its new
+// place in the indexes.
+//
+// The registry is not thread safe, the game service only accesses it with its state
+// mutex held. Lists returned from it are only valid until the registry is next modified.
+
+class GameClientRegistry
+{
+public:
+    using ClientList = std::vector<std::shared_ptr<GameClient>>;
+
+    void Add(const std::shared_ptr<GameClient>& Client);
+    void Remove(const std::shared_ptr<GameClient>& Client);
+
+    // Re-reads the clients player state and updates the indexes if any of the indexed values have changed.
+    void Update(GameClient* Client);
+
+    // If multiple clients share an id (eg. a player reconnecting before their old connection has timed out)
+    // the one that was indexed first is returned.
+    std::shared_ptr<GameClient> FindByPlayerId(uint32_t PlayerId) const;
+    std::shared_ptr<GameClient> FindBySteamId(const std::string& SteamId) const;
+
+    const ClientList& GetClients() const { return Clients; }
+    const ClientList& GetClientsInArea(OnlineAreaId Area) const;
+    const ClientList& GetClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool) const;
+
+    size_t Size() const { return Clients.size(); }
+    bool Empty() const  { return Clients.empty(); }
+
+private:
+
+    // The values each client is currently indexed under, so we can find it again when they change.
+    struct IndexedValues
+    {
+        std::shared_ptr<GameClient> Client;
+        uint32_t PlayerId = 0;
+        std::string SteamId;
+        OnlineAreaId Area = OnlineAreaId::None;
+        Frpg2RequestMessage::VisitorPool VisitorPool = Frpg2RequestMessage::VisitorPool::VisitorPool_None;
+    };
+
+    template <typename KeyType>
+    using ClientIndex = std::unordered_map<KeyType, ClientList>;
+
+    template <typename KeyType>
+    static void AddToIndex(ClientIndex<KeyType>& Index, const KeyType& Key, const std::shared_ptr<GameClient>& Client);
+
+    template <typename KeyType>
+    static void RemoveFromIndex(ClientIndex<KeyType>& Index, const KeyType& Key, const std::shared_ptr<GameClient>& Client);
+
+    template <typename KeyType>
+    static const ClientList& FindInIndex(const ClientIndex<KeyType>& Index, const KeyType& Key);
+
+    void AddToIndexes(const IndexedValues& Values);
+    void RemoveFromIndexes(const IndexedValues& Values);
+
+private:
+    // All clients in the order they were added.
+    ClientList Clients;
+
+    std::unordered_map<GameClient*, IndexedValues> Entries;
+
+    ClientIndex<uint32_t> ByPlayerId;
+    ClientIndex<std::string> BySteamId;
+    ClientIndex<OnlineAreaId> ByArea;
+    ClientIndex<Frpg2RequestMessage::VisitorPool> ByVisitorPool;
+
+};
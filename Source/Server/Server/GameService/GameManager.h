@@ -12,6 +12,7 @@
 #include <string>
 
 class GameClient;
+class GameMessageDispatcher;
 struct Frpg2ReliableUdpMessage;
 
 enum class MessageHandleResult
@@ -45,9 +46,9 @@ public:
     // Called when we have a lost a player previously registered with OnGainPlayer.
     virtual void OnLostPlayer(GameClient* Client) { };
 
-    // Called when a game client recieves a message.
-    // Returns true if an error occured and the client should be disconnected.
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) { return MessageHandleResult::Unhandled; }
+    // Called after Init to register handlers for the message types this manager 
+    // handles. Handlers return Error if the client should be disconnected.
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) { };
 
     // Returns a general descriptive name of the manager for logging.
     virtual std::string GetName() = 0;
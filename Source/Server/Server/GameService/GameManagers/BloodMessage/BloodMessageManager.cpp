@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/BloodMessage/BloodMessageManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -69,38 +70,15 @@ void BloodMessageManager::TrimDatabase()
     Database.TrimBloodMessages(MaxEntries);
 }
 
-MessageHandleResult BloodMessageManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BloodMessageManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestReentryBloodMessage)
-    {
-        return Handle_RequestReentryBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodMessageEvaluation)
-    {
-        return Handle_RequestGetBloodMessageEvaluation(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateBloodMessage)
-    {
-        return Handle_RequestCreateBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRemoveBloodMessage)
-    {
-        return Handle_RequestRemoveBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodMessageList)
-    {
-        return Handle_RequestGetBloodMessageList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestEvaluateBloodMessage)
-    {
-        return Handle_RequestEvaluateBloodMessage(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestReCreateBloodMessageList)
-    {
-        return Handle_RequestReCreateBloodMessageList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestReentryBloodMessage, this, &BloodMessageManager::Handle_RequestReentryBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodMessageEvaluation, this, &BloodMessageManager::Handle_RequestGetBloodMessageEvaluation);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateBloodMessage, this, &BloodMessageManager::Handle_RequestCreateBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRemoveBloodMessage, this, &BloodMessageManager::Handle_RequestRemoveBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodMessageList, this, &BloodMessageManager::Handle_RequestGetBloodMessageList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestEvaluateBloodMessage, this, &BloodMessageManager::Handle_RequestEvaluateBloodMessage);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestReCreateBloodMessageList, this, &BloodMessageManager::Handle_RequestReCreateBloodMessageList);
 }
 
 MessageHandleResult BloodMessageManager::Handle_RequestReentryBloodMessage(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -30,7 +30,7 @@ public:
     virtual void Poll() override;
     virtual void TrimDatabase() override;
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
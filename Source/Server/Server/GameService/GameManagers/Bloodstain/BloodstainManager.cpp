@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Bloodstain/BloodstainManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -61,22 +62,11 @@ void BloodstainManager::TrimDatabase()
     Database.TrimBloodStains(MaxEntries);
 }
 
-MessageHandleResult BloodstainManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BloodstainManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateBloodstain)
-    {
-        return Handle_RequestCreateBloodstain(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBloodstainList)
-    {
-        return Handle_RequestGetBloodstainList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetDeadingGhost)
-    {
-        return Handle_RequestGetDeadingGhost(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateBloodstain, this, &BloodstainManager::Handle_RequestCreateBloodstain);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBloodstainList, this, &BloodstainManager::Handle_RequestGetBloodstainList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetDeadingGhost, this, &BloodstainManager::Handle_RequestGetDeadingGhost);
 }
 
 MessageHandleResult BloodstainManager::Handle_RequestCreateBloodstain(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -8,7 +8,9 @@
  */
 
 #include "Server/GameService/GameManagers/Boot/BootManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -18,23 +20,16 @@
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
 
-BootManager::BootManager(Server* InServerInstance)
+BootManager::BootManager(Server* InServerInstance, GameService* InGameServiceInstance)
     : ServerInstance(InServerInstance)
+    , GameServiceInstance(InGameServiceInstance)
 {
 }
 
-MessageHandleResult BootManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BootManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestWaitForUserLogin)
-    {
-        return Handle_RequestWaitForUserLogin(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetAnnounceMessageList)
-    {
-        return Handle_RequestGetAnnounceMessageList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestWaitForUserLogin, this, &BootManager::Handle_RequestWaitForUserLogin);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetAnnounceMessageList, this, &BootManager::Handle_RequestGetAnnounceMessageList);
 }
 
 MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -54,6 +49,8 @@ MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Clie
 
     LogS(Client->GetName().c_str(), "Steam id '%s' has logged in as player %i.", State.SteamId.c_str(), State.PlayerId);
 
+    GameServiceInstance->UpdateClientIndexes(Client);
+
     // Send back response with our new player id.
     Frpg2RequestMessage::RequestWaitForUserLoginResponse Response;
     Response.set_steam_id(State.SteamId);
@@ -94,7 +91,8 @@ MessageHandleResult BootManager::Handle_RequestWaitForUserLogin(GameClient* Clie
     }
     UploadInfoPushMessageList->set_unknown_2(5);
 
-    if (!Client->MessageStream->Send(&UploadInfoPushMessage))
+    // Identical for every client, so only compress it once.
+    if (!Client->MessageStream->Send(&UploadInfoPushMessage, nullptr, true))
     {
         WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send UploadInfoPushMessage response.");
         return MessageHandleResult::Error;
@@ -154,7 +152,10 @@ MessageHandleResult BootManager::Handle_RequestGetAnnounceMessageList(GameClient
         DateTime->set_tzdiff(0);
     }
 
-    if (!Client->MessageStream->Send(&Response, &Message))
+    // Everyone gets the same announcements, so no point compressing them for each client. The
+    // message index is part of the cached data, but clients send the same requests in the same 
+    // order after logging in so it almost always matches.
+    if (!Client->MessageStream->Send(&Response, &Message, true))
     {
         WarningS(Client->GetName().c_str(), "Disconnecting client as failed to send RequestWaitForUserLoginResponse response.");
         return MessageHandleResult::Error;
@@ -13,6 +13,7 @@
 
 struct Frpg2ReliableUdpMessage;
 class Server;
+class GameService;
 
 // Handles client requests relating to the boot flow.
 // eg. Announcement messages, eula and alike.
@@ -21,9 +22,9 @@ class BootManager
     : public GameManager
 {
 public:    
-    BootManager(Server* InServerInstance);
+    BootManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -33,5 +34,6 @@ protected:
 
 private:
     Server* ServerInstance;
+    GameService* GameServiceInstance;
 
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/BreakIn/BreakInManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -29,22 +30,11 @@ void BreakInManager::OnLostPlayer(GameClient* Client)
 {
 }
 
-MessageHandleResult BreakInManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void BreakInManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetBreakInTargetList)
-    {
-        return Handle_RequestGetBreakInTargetList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestBreakInTarget)
-    {
-        return Handle_RequestBreakInTarget(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectBreakInTarget)
-    {
-        return Handle_RequestRejectBreakInTarget(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetBreakInTargetList, this, &BreakInManager::Handle_RequestGetBreakInTargetList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestBreakInTarget, this, &BreakInManager::Handle_RequestBreakInTarget);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectBreakInTarget, this, &BreakInManager::Handle_RequestRejectBreakInTarget);
 }
 
 bool BreakInManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<GameClient>& Match)
@@ -85,17 +75,14 @@ MessageHandleResult BreakInManager::Handle_RequestGetBreakInTargetList(GameClien
 {
     Frpg2RequestMessage::RequestGetBreakInTargetList* Request = (Frpg2RequestMessage::RequestGetBreakInTargetList*)Message.Protobuf.get();
     
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([this, Client, Request](const std::shared_ptr<GameClient>& OtherClient) {
-        if (Client == OtherClient.get())
-        {
-            return false;
-        }
-        if (OtherClient->GetPlayerState().CurrentArea != (OnlineAreaId)Request->online_area_id())
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    for (const std::shared_ptr<GameClient>& OtherClient : GameServiceInstance->GetClientsInArea((OnlineAreaId)Request->online_area_id()))
+    {
+        if (Client != OtherClient.get() && CanMatchWith(Request->matching_parameter(), OtherClient))
         {
-            return false;
+            PotentialTargets.push_back(OtherClient);
         }
-        return CanMatchWith(Request->matching_parameter(), OtherClient); 
-    });
+    }
 
     // TODO: Sort potential targets based on prioritization (more summons etc)
 
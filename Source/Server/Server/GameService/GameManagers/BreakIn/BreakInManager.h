@@ -26,7 +26,7 @@ class BreakInManager
 public:    
     BreakInManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Ghosts/GhostManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -61,18 +62,10 @@ void GhostManager::TrimDatabase()
     Database.TrimGhosts(MaxEntries);
 }
 
-MessageHandleResult GhostManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void GhostManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateGhostData)
-    {
-        return Handle_RequestCreateGhostData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetGhostDataList)
-    {
-        return Handle_RequestGetGhostDataList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateGhostData, this, &GhostManager::Handle_RequestCreateGhostData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetGhostDataList, this, &GhostManager::Handle_RequestGetGhostDataList);
 }
 
 MessageHandleResult GhostManager::Handle_RequestCreateGhostData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
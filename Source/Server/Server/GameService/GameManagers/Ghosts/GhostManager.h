@@ -29,7 +29,7 @@ public:
     virtual bool Init() override;
     virtual void TrimDatabase() override;
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
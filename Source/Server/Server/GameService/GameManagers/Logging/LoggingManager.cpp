@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Logging/LoggingManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -24,54 +25,19 @@ LoggingManager::LoggingManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult LoggingManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void LoggingManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyProtoBufLog)
-    {
-        return Handle_RequestNotifyProtoBufLog(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyKillEnemy)
-    {
-        return Handle_RequestNotifyKillEnemy(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyDisconnectSession)
-    {
-        return Handle_RequestNotifyDisconnectSession(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyRegisterCharacter)
-    {
-        return Handle_RequestNotifyRegisterCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyDie)
-    {
-        return Handle_RequestNotifyDie(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyKillBoss)
-    {
-        return Handle_RequestNotifyKillBoss(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyJoinMultiplay)
-    {
-        return Handle_RequestNotifyJoinMultiplay(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyLeaveMultiplay)
-    {
-        return Handle_RequestNotifyLeaveMultiplay(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifySummonSignResult)
-    {
-        return Handle_RequestNotifySummonSignResult(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyCreateSignResult)
-    {
-        return Handle_RequestNotifyCreateSignResult(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyBreakInResult)
-    {
-        return Handle_RequestNotifyBreakInResult(Client, Message);
-    }
-        
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyProtoBufLog, this, &LoggingManager::Handle_RequestNotifyProtoBufLog);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyKillEnemy, this, &LoggingManager::Handle_RequestNotifyKillEnemy);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyDisconnectSession, this, &LoggingManager::Handle_RequestNotifyDisconnectSession);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyRegisterCharacter, this, &LoggingManager::Handle_RequestNotifyRegisterCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyDie, this, &LoggingManager::Handle_RequestNotifyDie);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyKillBoss, this, &LoggingManager::Handle_RequestNotifyKillBoss);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyJoinMultiplay, this, &LoggingManager::Handle_RequestNotifyJoinMultiplay);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyLeaveMultiplay, this, &LoggingManager::Handle_RequestNotifyLeaveMultiplay);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifySummonSignResult, this, &LoggingManager::Handle_RequestNotifySummonSignResult);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyCreateSignResult, this, &LoggingManager::Handle_RequestNotifyCreateSignResult);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyBreakInResult, this, &LoggingManager::Handle_RequestNotifyBreakInResult);
 }
 
 MessageHandleResult LoggingManager::Handle_RequestNotifyProtoBufLog(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Misc/MiscManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameService.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -27,34 +28,14 @@ MiscManager::MiscManager(Server* InServerInstance, GameService* InGameServiceIns
 {
 }
 
-MessageHandleResult MiscManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void MiscManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestNotifyRingBell)
-    {
-        return Handle_RequestNotifyRingBell(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendMessageToPlayers)
-    {
-        return Handle_RequestSendMessageToPlayers(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestMeasureUploadBandwidth)
-    {
-        return Handle_RequestMeasureUploadBandwidth(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestMeasureDownloadBandwidth)
-    {
-        return Handle_RequestMeasureDownloadBandwidth(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetOnlineShopItemList)
-    {
-        return Handle_RequestGetOnlineShopItemList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestBenchmarkThroughput)
-    {
-        return Handle_RequestBenchmarkThroughput(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestNotifyRingBell, this, &MiscManager::Handle_RequestNotifyRingBell);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendMessageToPlayers, this, &MiscManager::Handle_RequestSendMessageToPlayers);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestMeasureUploadBandwidth, this, &MiscManager::Handle_RequestMeasureUploadBandwidth);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestMeasureDownloadBandwidth, this, &MiscManager::Handle_RequestMeasureDownloadBandwidth);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetOnlineShopItemList, this, &MiscManager::Handle_RequestGetOnlineShopItemList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestBenchmarkThroughput, this, &MiscManager::Handle_RequestBenchmarkThroughput);
 }
 
 void MiscManager::Poll()
@@ -80,9 +61,12 @@ MessageHandleResult MiscManager::Handle_RequestNotifyRingBell(GameClient* Client
         OnlineAreaId::Archdragon_Peak_Mausoleum_Lift
     };
 
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([Client, Request, NotifyLocations](const std::shared_ptr<GameClient>& OtherClient) {
-        return NotifyLocations.count(OtherClient->GetPlayerState().CurrentArea) > 0;
-    });
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    for (OnlineAreaId Location : NotifyLocations)
+    {
+        const std::vector<std::shared_ptr<GameClient>>& ClientsInLocation = GameServiceInstance->GetClientsInArea(Location);
+        PotentialTargets.insert(PotentialTargets.end(), ClientsInLocation.begin(), ClientsInLocation.end());
+    }
 
     for (std::shared_ptr<GameClient>& OtherClient : PotentialTargets)
     {
@@ -8,7 +8,9 @@
  */
 
 #include "Server/GameService/GameManagers/PlayerData/PlayerDataManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 
@@ -20,39 +22,20 @@
 
 #include "Core/Network/NetConnection.h"
 
-PlayerDataManager::PlayerDataManager(Server* InServerInstance)
+PlayerDataManager::PlayerDataManager(Server* InServerInstance, GameService* InGameServiceInstance)
     : ServerInstance(InServerInstance)
+    , GameServiceInstance(InGameServiceInstance)
 {
 }
 
-MessageHandleResult PlayerDataManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void PlayerDataManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateLoginPlayerCharacter)
-    {
-        return Handle_RequestUpdateLoginPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdatePlayerStatus)
-    {
-        return Handle_RequestUpdatePlayerStatus(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdatePlayerCharacter)
-    {
-        return Handle_RequestUpdatePlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetPlayerCharacter)
-    {
-        return Handle_RequestGetPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetLoginPlayerCharacter)
-    {
-        return Handle_RequestGetLoginPlayerCharacter(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetPlayerCharacterList)
-    {
-        return Handle_RequestGetPlayerCharacterList(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateLoginPlayerCharacter, this, &PlayerDataManager::Handle_RequestUpdateLoginPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdatePlayerStatus, this, &PlayerDataManager::Handle_RequestUpdatePlayerStatus);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdatePlayerCharacter, this, &PlayerDataManager::Handle_RequestUpdatePlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetPlayerCharacter, this, &PlayerDataManager::Handle_RequestGetPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetLoginPlayerCharacter, this, &PlayerDataManager::Handle_RequestGetLoginPlayerCharacter);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetPlayerCharacterList, this, &PlayerDataManager::Handle_RequestGetPlayerCharacterList);
 }
 
 MessageHandleResult PlayerDataManager::Handle_RequestUpdateLoginPlayerCharacter(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -199,6 +182,9 @@ MessageHandleResult PlayerDataManager::Handle_RequestUpdatePlayerStatus(GameClie
         }
     }
 
+    // Area and visitor pool may have changed, so make sure the client can be found by their new values.
+    GameServiceInstance->UpdateClientIndexes(Client);
+
     Frpg2RequestMessage::RequestUpdatePlayerStatusResponse Response;
     if (!Client->MessageStream->Send(&Response, &Message))
     {
@@ -13,6 +13,7 @@
 
 struct Frpg2ReliableUdpMessage;
 class Server;
+class GameService;
 
 // Handles client requests relating to storing, updating and retrieving
 // their characters data. I'm not sure how much the other managers actually
@@ -22,9 +23,9 @@ class PlayerDataManager
     : public GameManager
 {
 public:    
-    PlayerDataManager(Server* InServerInstance);
+    PlayerDataManager(Server* InServerInstance, GameService* InGameServiceInstance);
 
-    virtual MessageHandleResult OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message) override;
+    virtual void RegisterMessageHandlers(GameMessageDispatcher& Dispatcher) override;
 
     virtual std::string GetName() override;
 
@@ -38,5 +39,6 @@ protected:
 
 private:
     Server* ServerInstance;
+    GameService* GameServiceInstance;
 
 };
\ No newline at end of file
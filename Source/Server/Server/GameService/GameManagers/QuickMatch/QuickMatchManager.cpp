@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/QuickMatch/QuickMatchManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -48,46 +49,17 @@ void QuickMatchManager::Poll()
 {
 }
 
-MessageHandleResult QuickMatchManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void QuickMatchManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSearchQuickMatch)
-    {
-        return Handle_RequestSearchQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUnregisterQuickMatch)
-    {
-        return Handle_RequestUnregisterQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateQuickMatch)
-    {
-        return Handle_RequestUpdateQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestJoinQuickMatch)
-    {
-        return Handle_RequestJoinQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestAcceptQuickMatch)
-    {
-        return Handle_RequestAcceptQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectQuickMatch)
-    {
-        return Handle_RequestRejectQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRegisterQuickMatch)
-    {
-        return Handle_RequestRegisterQuickMatch(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendQuickMatchStart)
-    {
-        return Handle_RequestSendQuickMatchStart(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSendQuickMatchResult)
-    {
-        return Handle_RequestSendQuickMatchResult(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSearchQuickMatch, this, &QuickMatchManager::Handle_RequestSearchQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUnregisterQuickMatch, this, &QuickMatchManager::Handle_RequestUnregisterQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateQuickMatch, this, &QuickMatchManager::Handle_RequestUpdateQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestJoinQuickMatch, this, &QuickMatchManager::Handle_RequestJoinQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestAcceptQuickMatch, this, &QuickMatchManager::Handle_RequestAcceptQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectQuickMatch, this, &QuickMatchManager::Handle_RequestRejectQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRegisterQuickMatch, this, &QuickMatchManager::Handle_RequestRegisterQuickMatch);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendQuickMatchStart, this, &QuickMatchManager::Handle_RequestSendQuickMatchStart);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSendQuickMatchResult, this, &QuickMatchManager::Handle_RequestSendQuickMatchResult);
 }
 
 bool QuickMatchManager::CanMatchWith(GameClient* Client, const Frpg2RequestMessage::RequestSearchQuickMatch& Request, const std::shared_ptr<Match>& Match)
@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Ranking/RankingManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
 #include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
@@ -23,26 +24,12 @@ RankingManager::RankingManager(Server* InServerInstance)
 {
 }
 
-MessageHandleResult RankingManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void RankingManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRegisterRankingData)
-    {
-        return Handle_RequestRegisterRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetRankingData)
-    {
-        return Handle_RequestGetRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetCharacterRankingData)
-    {
-        return Handle_RequestGetCharacterRankingData(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCountRankingData)
-    {
-        return Handle_RequestCountRankingData(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRegisterRankingData, this, &RankingManager::Handle_RequestRegisterRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetRankingData, this, &RankingManager::Handle_RequestGetRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetCharacterRankingData, this, &RankingManager::Handle_RequestGetCharacterRankingData);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCountRankingData, this, &RankingManager::Handle_RequestCountRankingData);
 }
 
 MessageHandleResult RankingManager::Handle_RequestRegisterRankingData(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Signs/SignManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -41,38 +42,15 @@ void SignManager::Poll()
 {
 }
 
-MessageHandleResult SignManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void SignManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetSignList)
-    {
-        return Handle_RequestGetSignList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestCreateSign)
-    {
-        return Handle_RequestCreateSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRemoveSign)
-    {
-        return Handle_RequestRemoveSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestUpdateSign)
-    {
-        return Handle_RequestUpdateSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestSummonSign)
-    {
-        return Handle_RequestSummonSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectSign)
-    {
-        return Handle_RequestRejectSign(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetRightMatchingArea)
-    {
-        return Handle_RequestGetRightMatchingArea(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetSignList, this, &SignManager::Handle_RequestGetSignList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestCreateSign, this, &SignManager::Handle_RequestCreateSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRemoveSign, this, &SignManager::Handle_RequestRemoveSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestUpdateSign, this, &SignManager::Handle_RequestUpdateSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestSummonSign, this, &SignManager::Handle_RequestSummonSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectSign, this, &SignManager::Handle_RequestRejectSign);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetRightMatchingArea, this, &SignManager::Handle_RequestGetRightMatchingArea);
 }
 
 bool SignManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Host, const Frpg2RequestMessage::MatchingParameter& Match, bool IsRedSign)
@@ -442,7 +420,7 @@ MessageHandleResult SignManager::Handle_RequestGetRightMatchingArea(GameClient*
     std::unordered_map<OnlineAreaId, int> PotentialAreas;
     int MaxAreaPopulation = 1;
 
-    for (std::shared_ptr<GameClient>& OtherClient : GameServiceInstance->GetClients())
+    for (const std::shared_ptr<GameClient>& OtherClient : GameServiceInstance->GetClients())
     {
         int OtherSoulLevel = OtherClient->GetPlayerState().SoulLevel;
         int OtherWeaponLevel = OtherClient->GetPlayerState().MaxWeaponLevel;
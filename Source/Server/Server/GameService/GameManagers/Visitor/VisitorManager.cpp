@@ -8,6 +8,7 @@
  */
 
 #include "Server/GameService/GameManagers/Visitor/VisitorManager.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 #include "Server/GameService/GameClient.h"
 #include "Server/GameService/GameService.h"
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
@@ -25,22 +26,11 @@ VisitorManager::VisitorManager(Server* InServerInstance, GameService* InGameServ
 {
 }
 
-MessageHandleResult VisitorManager::OnMessageRecieved(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+void VisitorManager::RegisterMessageHandlers(GameMessageDispatcher& Dispatcher)
 {
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestGetVisitorList)
-    {
-        return Handle_RequestGetVisitorList(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestVisit)
-    {
-        return Handle_RequestVisit(Client, Message);
-    }
-    else if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::RequestRejectVisit)
-    {
-        return Handle_RequestRejectVisit(Client, Message);
-    }
-
-    return MessageHandleResult::Unhandled;
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestGetVisitorList, this, &VisitorManager::Handle_RequestGetVisitorList);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestVisit, this, &VisitorManager::Handle_RequestVisit);
+    Dispatcher.Register(Frpg2ReliableUdpMessageType::RequestRejectVisit, this, &VisitorManager::Handle_RequestRejectVisit);
 }
 
 bool VisitorManager::CanMatchWith(const Frpg2RequestMessage::MatchingParameter& Request, const std::shared_ptr<GameClient>& Match)
@@ -78,17 +68,14 @@ MessageHandleResult VisitorManager::Handle_RequestGetVisitorList(GameClient* Cli
 {
     Frpg2RequestMessage::RequestGetVisitorList* Request = (Frpg2RequestMessage::RequestGetVisitorList*)Message.Protobuf.get();
     
-    std::vector<std::shared_ptr<GameClient>> PotentialTargets = GameServiceInstance->FindClients([this, Client, Request](const std::shared_ptr<GameClient>& OtherClient) {
-        if (Client == OtherClient.get())
-        {
-            return false;
-        }
-        if (Request->visitor_pool() != OtherClient->GetPlayerState().VisitorPool)
+    std::vector<std::shared_ptr<GameClient>> PotentialTargets;
+    for (const std::shared_ptr<GameClient>& OtherClient : GameServiceInstance->GetClientsInVisitorPool(Request->visitor_pool()))
+    {
+        if (Client != OtherClient.get() && CanMatchWith(Request->matching_parameter(), OtherClient))
         {
-            return false;
+            PotentialTargets.push_back(OtherClient);
         }
-        return CanMatchWith(Request->matching_parameter(), OtherClient); 
-    });
+    }
 
     // TODO: Sort potential targets based on prioritization (more summons etc)
 
@@ -0,0 +1,120 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/GameService/GameMessageDispatcher.h"
+
+#include "Core/Utils/Logging.h"
+
+#include <chrono>
+
+GameMessageDispatcher::GameMessageDispatcher()
+{
+    Entries.resize(GetMaxReliableUdpMessageType() + 1);
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         Entries[OpCode].Statistics.TypeName = #Type; Entries[OpCode].bExpected = true;
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         Entries[OpCode].Statistics.TypeName = #Type; Entries[OpCode].bExpected = true;
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Server only sends these */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
+}
+
+GameMessageDispatcher::Entry* GameMessageDispatcher::FindEntry(Frpg2ReliableUdpMessageType Type)
+{
+    size_t Index = static_cast<size_t>(Type);
+    if (Index >= Entries.size())
+    {
+        return nullptr;
+    }
+    return &Entries[Index];
+}
+
+bool GameMessageDispatcher::Register(Frpg2ReliableUdpMessageType Type, const std::string& ManagerName, Handler InHandler)
+{
+    Entry* Found = FindEntry(Type);
+    if (Found == nullptr || !Found->bExpected)
+    {
+        Error("Game manager '%s' attempted to register handler for unknown message type 0x%04x.", ManagerName.c_str(), static_cast<uint32_t>(Type));
+        FailedRegistrations++;
+        return false;
+    }
+
+    if (Found->Function)
+    {
+        Error("Game manager '%s' attempted to register handler for %s, which is already handled by '%s'.", ManagerName.c_str(), Found->Statistics.TypeName.c_str(), Found->Statistics.ManagerName.c_str());
+        FailedRegistrations++;
+        return false;
+    }
+
+    Found->Function = std::move(InHandler);
+    Found->Statistics.ManagerName = ManagerName;
+
+    return true;
+}
+
+bool GameMessageDispatcher::Validate()
+{
+    bool bValid = (FailedRegistrations == 0);
+    if (!bValid)
+    {
+        Error("%i game message handlers failed to register.", (int)FailedRegistrations);
+    }
+
+    for (Entry& Value : Entries)
+    {
+        if (Value.bExpected && !Value.Function)
+        {
+            Warning("No game manager handles %s messages, clients sending them will be treated as sending an unhandled message.", Value.Statistics.TypeName.c_str());
+        }
+    }
+
+    return bValid;
+}
+
+MessageHandleResult GameMessageDispatcher::Dispatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message)
+{
+    Entry* Found = FindEntry(Message.Header.msg_type);
+    if (Found == nullptr || !Found->Function)
+    {
+        return MessageHandleResult::Unhandled;
+    }
+
+    auto StartTime = std::chrono::high_resolution_clock::now();
+
+    MessageHandleResult Result = Found->Function(Client, Message);
+
+    auto EndTime = std::chrono::high_resolution_clock::now();
+    double Elapsed = std::chrono::duration<double>(EndTime - StartTime).count();
+
+    HandlerStatistics& Statistics = Found->Statistics;
+    Statistics.CallCount++;
+    Statistics.TotalTime += Elapsed;
+    if (Elapsed > Statistics.PeakTime)
+    {
+        Statistics.PeakTime = Elapsed;
+    }
+
+    return Result;
+}
+
+std::vector<GameMessageDispatcher::HandlerStatistics> GameMessageDispatcher::GetStatistics()
+{
+    std::vector<HandlerStatistics> Result;
+
+    for (Entry& Value : Entries)
+    {
+        if (Value.Function)
+        {
+            Result.push_back(Value.Statistics);
+        }
+    }
+
+    return Result;
+}
@@ -0,0 +1,90 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include "Server/GameService/GameManager.h"
+#include "Server/Streams/Frpg2ReliableUdpMessage.h"
+
+#include <functional>
+#include <vector>
+#include <string>
+
+// Routes messages recieved by game clients to the manager that handles them. Managers 
+// register a handler for each message type they handle when the game service is 
+// initialized, recieved messages are then dispatched with a single table lookup 
+// indexed by message type.
+//
+// Each handler also keeps track of how often its called and how long it takes.
+//
+// The dispatcher is filled during initialization and only read afterwards. Dispatch 
+// updates the handler statistics, so it needs to be called with the game services 
+// state mutex held, as does anything reading the statistics.
+
+class GameMessageDispatcher
+{
+public:
+    using Handler = std::function<MessageHandleResult(GameClient* Client, const Frpg2ReliableUdpMessage& Message)>;
+
+    struct HandlerStatistics
+    {
+        std::string TypeName;
+        std::string ManagerName;
+        size_t CallCount = 0;
+        double TotalTime = 0.0;
+        double PeakTime = 0.0;
+    };
+
+public:
+    GameMessageDispatcher();
+
+    // Registers the function that handles the given message type. Each type
+    // can only have one handler. Failures are also remembered and reported by Validate.
+    bool Register(Frpg2ReliableUdpMessageType Type, const std::string& ManagerName, Handler InHandler);
+
+    // Helper for registering a manager member function as a handler.
+    template <typename ManagerType>
+    bool Register(Frpg2ReliableUdpMessageType Type, ManagerType* Manager, MessageHandleResult (ManagerType::*Function)(GameClient*, const Frpg2ReliableUdpMessage&))
+    {
+        return Register(Type, Manager->GetName(), [Manager, Function](GameClient* Client, const Frpg2ReliableUdpMessage& Message) {
+            return (Manager->*Function)(Client, Message);
+        });
+    }
+
+    // Checks that every message type the client can send us has a handler. Should
+    // be called once all managers have registered their handlers. Returns false if 
+    // any registration failed (unknown types or types registered more than once).
+    bool Validate();
+
+    // Passes the message on to the registered handler, returns Unhandled if there isn't one.
+    MessageHandleResult Dispatch(GameClient* Client, const Frpg2ReliableUdpMessage& Message);
+
+    // Statistics for each message type that has a handler registered.
+    std::vector<HandlerStatistics> GetStatistics();
+
+private:
+    struct Entry
+    {
+        Handler Function;
+        HandlerStatistics Statistics;
+
+        // Set for types the client sends us, which we expect to have a handler.
+        bool bExpected = false;
+    };
+
+    Entry* FindEntry(Frpg2ReliableUdpMessageType Type);
+
+    // Indexed directly by message type.
+    std::vector<Entry> Entries;
+
+    // Number of calls to Register that failed, callers don't check the result
+    // so Validate fails if this is non-zero.
+    size_t FailedRegistrations = 0;
+
+};
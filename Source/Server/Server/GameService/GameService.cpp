@@ -29,6 +29,8 @@
 
 #include "Core/Network/NetConnection.h"
 #include "Core/Network/NetConnectionUDP.h"
+#include "Core/Network/NetEventLoop.h"
+#include "Core/Crypto/CWCClientUDPCipher.h"
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
 
@@ -37,15 +39,18 @@
 
 #include "Server/GameService/Utils/GameIds.h"
 
+#include <algorithm>
+
 GameService::GameService(Server* OwningServer, RSAKeyPair* InServerRSAKey)
     : ServerInstance(OwningServer)
     , ServerRSAKey(InServerRSAKey)
+    , PayloadCache(BuildConfig::PAYLOAD_CACHE_MAX_ENTRIES)
 {
     // This list of managers are what actually do the grunt work of the server
     // they recieve and response to messages.
-    Managers.push_back(std::make_shared<BootManager>(ServerInstance));
+    Managers.push_back(std::make_shared<BootManager>(ServerInstance, this));
     Managers.push_back(std::make_shared<LoggingManager>(ServerInstance));
-    Managers.push_back(std::make_shared<PlayerDataManager>(ServerInstance));
+    Managers.push_back(std::make_shared<PlayerDataManager>(ServerInstance, this));
     Managers.push_back(std::make_shared<BloodMessageManager>(ServerInstance, this));
     Managers.push_back(std::make_shared<BloodstainManager>(ServerInstance));
     Managers.push_back(std::make_shared<SignManager>(ServerInstance, this));
@@ -64,15 +69,68 @@ GameService::~GameService()
 
 bool GameService::Init()
 {
-    Connection = std::make_shared<NetConnectionUDP>("Game Service");
-    int Port = ServerInstance->GetConfig().GameServerPort;
-    if (!Connection->Listen(Port))
+    const RuntimeConfig& Config = ServerInstance->GetConfig();
+    int Port = Config.GameServerPort;
+
+    int ShardCount = Config.GameServerShardCount;
+    if (ShardCount < 1)
     {
-        Error("Game service failed to listen on port %i.", Port);
-        return false;
+        ShardCount = 1;
+    }
+#if !defined(__linux__)
+    // Sharding relies on the kernel spreading datagrams between SO_REUSEPORT sockets, which
+    // only linux does. Elsewhere (windows has no SO_REUSEPORT at all) we run a single shard.
+    if (ShardCount > 1)
+    {
+        Warning("Game service sharding is only supported on linux, running with a single shard.");
+        ShardCount = 1;
+    }
+#endif
+
+    bThreadedShards = (ShardCount > 1);
+
+    for (int i = 0; i < ShardCount; i++)
+    {
+        std::unique_ptr<GameServiceShard> Shard = std::make_unique<GameServiceShard>();
+        Shard->Index = i;
+        Shard->Connection = std::make_shared<NetConnectionUDP>(bThreadedShards ? StringFormat("Game Service %i", i) : "Game Service");
+        Shard->Connection->SetReusePort(bThreadedShards);
+        if (!Shard->Connection->Listen(Port))
+        {
+            Error("Game service failed to listen on port %i.", Port);
+            return false;
+        }
+        Shard->Connection->SetBatchedIO(Config.GameServerBatchedIO);
+        Shard->Connection->SetAdmissionFilter([this](const NetIPAddress& Address, const uint8_t* Data, int Length) {
+            return AdmitConnection(Address, Data, Length);
+        });
+
+        if (bThreadedShards)
+        {
+            Shard->EventLoop = std::make_unique<NetEventLoop>();
+            if (!Shard->EventLoop->Init())
+            {
+                Error("Game service failed to create event loop for shard %i.", i);
+                return false;
+            }
+            Shard->Connection->SetEventLoop(Shard->EventLoop.get());
+        }
+        else
+        {
+            Shard->Connection->SetEventLoop(&ServerInstance->GetEventLoop());
+        }
+
+        Shards.push_back(std::move(Shard));
     }
 
-    Log("Game service is now listening on port %i.", Port);
+    if (bThreadedShards)
+    {
+        Log("Game service is now listening on port %i with %i shards.", Port, ShardCount);
+    }
+    else
+    {
+        Log("Game service is now listening on port %i.", Port);
+    }
 
     for (auto& Manager : Managers)
     {
@@ -81,15 +139,44 @@ bool GameService::Init()
             Error("Failed to initialize game manager '%s'", Manager->GetName().c_str());
             return false;
         }
+
+        Manager->RegisterMessageHandlers(MessageDispatcher);
+    }
+
+    if (!MessageDispatcher.Validate())
+    {
+        Error("Game managers failed to register their message handlers.");
+        return false;
     }
 
     TrimDatabase();
 
+    if (bThreadedShards)
+    {
+        for (auto& Shard : Shards)
+        {
+            GameServiceShard* ShardPtr = Shard.get();
+            Shard->Thread = std::thread([this, ShardPtr]() { 
+                RunShard(*ShardPtr); 
+            });
+        }
+    }
+
     return true;
 }
 
 bool GameService::Term()
 {
+    bShardsQuitting = true;
+    for (auto& Shard : Shards)
+    {
+        if (Shard->Thread.joinable())
+        {
+            Shard->EventLoop->Wake();
+            Shard->Thread.join();
+        }
+    }
+
     for (auto& Manager : Managers)
     {
         if (!Manager->Term())
@@ -118,31 +205,84 @@ void GameService::TrimDatabase()
 
 void GameService::Poll()
 {
-    Connection->Pump();
+    // Threaded shards are polled by their own threads.
+    if (!bThreadedShards)
+    {
+        PollShard(*Shards[0]);
+    }
+
+    std::scoped_lock lock(StateMutex);
 
     for (auto& Manager : Managers)
     {
         Manager->Poll();
     }
 
-    while (std::shared_ptr<NetConnection> ClientConnection = Connection->Accept())
+    if (GetSeconds() > NextDatabaseTrim)
     {
-        HandleClientConnection(ClientConnection);
+        TrimDatabase();
     }
 
-    if (GetSeconds() > NextDatabaseTrim)
+    // Remove authentication states that have timed out.
+    Timers.Advance(GetSeconds());
+}
+
+void GameService::PollShard(GameServiceShard& Shard)
+{
+    Shard.Timers.Advance(GetSeconds());
+
+    Shard.Connection->Pump();
+
     {
-        TrimDatabase();
+        std::scoped_lock lock(StateMutex);
+
+        while (std::shared_ptr<NetConnection> ClientConnection = Shard.Connection->Accept())
+        {
+            HandleClientConnection(Shard, ClientConnection);
+        }
     }
 
-    for (auto iter = Clients.begin(); iter != Clients.end(); /* empty */)
+    // The network side of each client only touches that client, so this 
+    // is done without holding the state lock.
+    std::vector<std::shared_ptr<GameClient>> LostClients;
+    for (auto iter = Shard.Clients.begin(); iter != Shard.Clients.end(); /* empty */)
     {
-        std::shared_ptr<GameClient> Client = *iter;
+        if ((*iter)->PollNetwork())
+        {
+            LostClients.push_back(*iter);
+            iter = Shard.Clients.erase(iter);
+        }
+        else
+        {
+            iter++;
+        }
+    }
+
+    {
+        std::scoped_lock lock(StateMutex);
 
-        if (Client->Poll())
+        size_t MessagesHandled = 0;
+        for (auto iter = Shard.Clients.begin(); iter != Shard.Clients.end(); /* empty */)
+        {
+            size_t PreviousMessagesHandled = (*iter)->MessagesHandled;
+            bool bLost = (*iter)->PollMessages();
+            MessagesHandled += (*iter)->MessagesHandled - PreviousMessagesHandled;
+
+            if (bLost)
+            {
+                LostClients.push_back(*iter);
+                iter = Shard.Clients.erase(iter);
+            }
+            else
+            {
+                iter++;
+            }
+        }
+
+        for (std::shared_ptr<GameClient>& Client : LostClients)
         {
             LogS(Client->GetName().c_str(), "Disconnecting client connection.");
-            DisconnectingClients.push_back(Client);
+            Shard.DisconnectingClients.push_back(Client);
 
             Client->MessageStream->Disconnect();
 
@@ -153,15 +293,23 @@ void GameService::Poll()
                 Manager->OnLostPlayer(Client.get());
             }
 
-            iter = Clients.erase(iter);
+            ClientRegistry.Remove(Client);
         }
-        else
+
+        // Handlers can send messages to clients in any shard, wake the others up so they get sent.
+        if (bThreadedShards && MessagesHandled > 0)
         {
-            iter++;
+            for (auto& OtherShard : Shards)
+            {
+                if (OtherShard.get() != &Shard)
+                {
+                    OtherShard->EventLoop->Wake();
+                }
+            }
         }
     }
     
-    for (auto iter = DisconnectingClients.begin(); iter != DisconnectingClients.end(); /* empty */)
+    for (auto iter = Shard.DisconnectingClients.begin(); iter != Shard.DisconnectingClients.end(); /* empty */)
     {
         std::shared_ptr<GameClient> Client = *iter;
 
@@ -172,7 +320,7 @@ void GameService::Poll()
         {
             LogS(Client->GetName().c_str(), "Client disconnected.");
 
-            iter = DisconnectingClients.erase(iter);
+            iter = Shard.DisconnectingClients.erase(iter);
         }
         else
         {
@@ -180,25 +328,154 @@ void GameService::Poll()
         }
     }
 
-    // Remove authentication states that have timed out.
-    for (auto iter = AuthenticationStates.begin(); iter != AuthenticationStates.end(); /* empty */)
+    // Push out everything that was queued for sending this frame.
+    Shard.Connection->Flush();
+}
+
+void GameService::RunShard(GameServiceShard& Shard)
+{
+    while (!bShardsQuitting)
     {
-        auto& Pair = *iter;
+        PollShard(Shard);
+
+        Shard.EventLoop->Wait(GetShardNextPollTime(Shard));
+    }
+}
+
+double GameService::GetShardNextPollTime(GameServiceShard& Shard)
+{
+    double NextPollTime = GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+
+    // Client timeouts and retransmits.
+    double NextTimerTime = Shard.Timers.GetNextDeadline();
+    if (NextTimerTime < NextPollTime)
+    {
+        NextPollTime = NextTimerTime;
+    }
 
-        double ElapsedTime = GetSeconds() - Pair.second.LastRefreshTime;
-        if (ElapsedTime > BuildConfig::AUTH_TICKET_TIMEOUT)
+    // Queued packets, delayed acks, handshakes, etc.
+    for (auto& Client : Shard.Clients)
+    {
+        double ClientPollTime = Client->GetNextPollTime();
+        if (ClientPollTime < NextPollTime)
         {
-            Log("Authentication token 0x%016llx has expired.", Pair.second.AuthToken);
-            iter = AuthenticationStates.erase(iter);
+            NextPollTime = ClientPollTime;
         }
-        else
+    }
+    for (auto& Client : Shard.DisconnectingClients)
+    {
+        double ClientPollTime = Client->MessageStream->GetNextPollTime();
+        if (ClientPollTime < NextPollTime)
         {
-            iter++;
+            NextPollTime = ClientPollTime;
+        }
+    }
+
+    return NextPollTime;
+}
+
+void GameService::WakeShard(size_t ShardIndex)
+{
+    if (!bThreadedShards)
+    {
+        ServerInstance->GetEventLoop().Wake();
+    }
+    else if (ShardIndex < Shards.size())
+    {
+        Shards[ShardIndex]->EventLoop->Wake();
+    }
+}
+
+double GameService::GetNextPollTime()
+{
+    std::scoped_lock lock(StateMutex);
+
+    double NextPollTime = GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+
+    // Threaded shards wait on their own event loops, otherwise the shard is polled along with us.
+    if (!bThreadedShards)
+    {
+        NextPollTime = GetShardNextPollTime(*Shards[0]);
+    }
+
+    if (NextDatabaseTrim < NextPollTime)
+    {
+        NextPollTime = NextDatabaseTrim;
+    }
+
+    // Auth token expiry.
+    double NextTimerTime = Timers.GetNextDeadline();
+    if (NextTimerTime < NextPollTime)
+    {
+        NextPollTime = NextTimerTime;
+    }
+
+    return NextPollTime;
+}
+
+NetConnectionUDPStatistics GameService::GetConnectionStatistics()
+{
+    NetConnectionUDPStatistics Result;
+
+    for (auto& Shard : Shards)
+    {
+        NetConnectionUDPStatistics ShardStatistics = Shard->Connection->GetStatistics();
+        Result.RecieveCalls += ShardStatistics.RecieveCalls;
+        Result.DatagramsRecieved += ShardStatistics.DatagramsRecieved;
+        Result.SendCalls += ShardStatistics.SendCalls;
+        Result.DatagramsSent += ShardStatistics.DatagramsSent;
+        Result.DatagramsRateLimited += ShardStatistics.DatagramsRateLimited;
+        Result.DatagramsRejected += ShardStatistics.DatagramsRejected;
+        Result.DatagramsSendDropped += ShardStatistics.DatagramsSendDropped;
+        if (ShardStatistics.LastDrainTime > Result.LastDrainTime)
+        {
+            Result.LastDrainTime = ShardStatistics.LastDrainTime;
         }
+        if (ShardStatistics.PeakDrainTime > Result.PeakDrainTime)
+        {
+            Result.PeakDrainTime = ShardStatistics.PeakDrainTime;
+        }
+    }
+
+    return Result;
+}
+
+bool GameService::AdmitConnection(const NetIPAddress& Address, const uint8_t* Data, int Length)
+{
+    // Auth token, iv, tag, packet type and at least one byte of payload.
+    if (Length < 8 + 11 + 16 + 1 + 1)
+    {
+        return false;
+    }
+
+    uint64_t AuthToken = *reinterpret_cast<const uint64_t*>(Data);
+
+    std::scoped_lock lock(StateMutex);
+
+    auto AuthStateIter = AuthenticationStates.find(AuthToken);
+    if (AuthStateIter == AuthenticationStates.end())
+    {
+        return false;
     }
+
+    // Make sure the datagram was actually encrypted with the key for this token, otherwise
+    // anyone who can see the token go past can open connections with it.
+    GameClientAuthenticationState& AuthState = AuthStateIter->second;
+    if (!AuthState.AdmissionCipher)
+    {
+        AuthState.AdmissionCipher = std::make_shared<CWCClientUDPCipher>(AuthState.CwcKey, AuthState.AuthToken);
+    }
+
+    AdmissionBuffer.assign(Data, Data + Length);
+    if (!AuthState.AdmissionCipher->DecryptInPlace(AdmissionBuffer.data(), AdmissionBuffer.size()))
+    {
+        return false;
+    }
+
+    return true;
 }
 
-void GameService::HandleClientConnection(std::shared_ptr<NetConnection> ClientConnection)
+void GameService::HandleClientConnection(GameServiceShard& Shard, std::shared_ptr<NetConnection> ClientConnection)
 {
     uint64_t AuthToken;
     int BytesRecieved = 0;
@@ -226,7 +503,14 @@ void GameService::HandleClientConnection(std::shared_ptr<NetConnection> ClientCo
     GameClientAuthenticationState& AuthState = (*AuthStateIter).second;
 
     std::shared_ptr<GameClient> Client = std::make_shared<GameClient>(this, ClientConnection, AuthState.CwcKey, AuthState.AuthToken);
-    Clients.push_back(Client);
+    Client->ShardIndex = Shard.Index;
+    Client->MessageStream->SetTimerWheel(&Shard.Timers);
+    Client->MessageStream->SetAckDelay(GetServer()->GetConfig().GameServerAckDelay);
+    Client->MessageStream->SetPayloadCache(&PayloadCache);
+    Shard.Clients.push_back(Client);
+    ClientRegistry.Add(Client);
+
+    ScheduleClientTimeout(Shard, Client, Client->GetLastMessageRecievedTime() + BuildConfig::CLIENT_TIMEOUT);
 
     // Let all managers know this client connected.
     for (auto& Manager : Managers)
@@ -242,17 +526,72 @@ std::string GameService::GetName()
 
 void GameService::CreateAuthToken(uint64_t AuthToken, const std::vector<uint8_t>& CwcKey)
 {
-    LogS(Connection->GetName().c_str(), "Created authentication token 0x%016llx", AuthToken);
+    std::scoped_lock lock(StateMutex);
+
+    LogS(GetName().c_str(), "Created authentication token 0x%016llx", AuthToken);
 
     GameClientAuthenticationState AuthState;
     AuthState.AuthToken = AuthToken;
     AuthState.CwcKey = CwcKey;
     AuthState.LastRefreshTime = GetSeconds();
-    AuthenticationStates.insert({ AuthToken, AuthState });
+    if (AuthenticationStates.insert({ AuthToken, AuthState }).second)
+    {
+        ScheduleAuthTokenExpiry(AuthToken, AuthState.LastRefreshTime + BuildConfig::AUTH_TICKET_TIMEOUT);
+    }
+}
+
+void GameService::ScheduleAuthTokenExpiry(uint64_t AuthToken, double Deadline)
+{
+    // Refreshing a token doesn't touch the timer, instead when it fires we check 
+    // if the token has been refreshed since and reschedule it if so.
+    Timers.Schedule(Deadline, [this, AuthToken]() {
+        auto AuthStateIter = AuthenticationStates.find(AuthToken);
+        if (AuthStateIter == AuthenticationStates.end())
+        {
+            return;
+        }
+
+        double ExpireTime = AuthStateIter->second.LastRefreshTime + BuildConfig::AUTH_TICKET_TIMEOUT;
+        if (GetSeconds() > ExpireTime)
+        {
+            Log("Authentication token 0x%016llx has expired.", AuthToken);
+            AuthenticationStates.erase(AuthStateIter);
+        }
+        else
+        {
+            ScheduleAuthTokenExpiry(AuthToken, ExpireTime);
+        }
+    });
+}
+
+void GameService::ScheduleClientTimeout(GameServiceShard& Shard, std::shared_ptr<GameClient> Client, double Deadline)
+{
+    // As with auth tokens, we only check when the timer fires if the client has
+    // recieved anything since it was scheduled.
+    std::weak_ptr<GameClient> WeakClient = Client;
+    Shard.Timers.Schedule(Deadline, [this, &Shard, WeakClient]() {
+        std::shared_ptr<GameClient> Client = WeakClient.lock();
+        if (!Client)
+        {
+            return;
+        }
+
+        double TimeoutTime = Client->GetLastMessageRecievedTime() + BuildConfig::CLIENT_TIMEOUT;
+        if (GetSeconds() >= TimeoutTime)
+        {
+            Client->TimedOut = true;
+        }
+        else
+        {
+            ScheduleClientTimeout(Shard, Client, TimeoutTime);
+        }
+    });
 }
 
 void GameService::RefreshAuthToken(uint64_t AuthToken)
 {
+    std::scoped_lock lock(StateMutex);
+
     auto AuthStateIter = AuthenticationStates.find(AuthToken);
     if (AuthStateIter == AuthenticationStates.end())
     {
@@ -264,27 +603,43 @@ void GameService::RefreshAuthToken(uint64_t AuthToken)
 
 std::shared_ptr<GameClient> GameService::FindClientByPlayerId(uint32_t PlayerId)
 {
-    for (std::shared_ptr<GameClient>& Client : Clients)
-    {
-        if (Client->GetPlayerState().PlayerId == PlayerId)
-        {
-            return Client;
-        }
-    }
-    return nullptr;
+    std::scoped_lock lock(StateMutex);
+
+    return ClientRegistry.FindByPlayerId(PlayerId);
 }
 
-std::vector<std::shared_ptr<GameClient>> GameService::FindClients(std::function<bool(const std::shared_ptr<GameClient>&)> Predicate)
+std::shared_ptr<GameClient> GameService::FindClientBySteamId(const std::string& SteamId)
 {
-    std::vector<std::shared_ptr<GameClient>> Result;
+    std::scoped_lock lock(StateMutex);
 
-    for (std::shared_ptr<GameClient>& Client : Clients)
-    {
-        if (Predicate(Client))
-        {
-            Result.push_back(Client);
-        }
-    }
+    return ClientRegistry.FindBySteamId(SteamId);
+}
 
-    return Result;
+const std::vector<std::shared_ptr<GameClient>>& GameService::GetClientsInArea(OnlineAreaId Area)
+{
+    return ClientRegistry.GetClientsInArea(Area);
+}
+
+const std::vector<std::shared_ptr<GameClient>>& GameService::GetClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool)
+{
+    return ClientRegistry.GetClientsInVisitorPool(Pool);
+}
+
+const std::vector<std::shared_ptr<GameClient>>& GameService::GetClients()
+{
+    return ClientRegistry.GetClients();
+}
+
+size_t GameService::GetClientCount()
+{
+    std::scoped_lock lock(StateMutex);
+
+    return ClientRegistry.Size();
+}
+
+void GameService::UpdateClientIndexes(GameClient* Client)
+{
+    std::scoped_lock lock(StateMutex);
+
+    ClientRegistry.Update(Client);
 }
@@ -10,18 +10,27 @@
 #pragma once
 
 #include "Server/Service.h"
+#include "Core/Utils/TimerWheel.h"
+#include "Server/Streams/Frpg2ReliableUdpPayloadCache.h"
+#include "Server/GameService/GameMessageDispatcher.h"
+#include "Server/GameService/GameClientRegistry.h"
 
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <atomic>
 
 class Server;
 class GameClient;
 class GameManager;
 class NetConnection;
 class NetConnectionUDP;
+class NetEventLoop;
+class NetIPAddress;
+struct NetConnectionUDPStatistics;
 class RSAKeyPair;
 class Cipher;
 
@@ -34,6 +43,34 @@ struct GameClientAuthenticationState
     uint64_t AuthToken;
     std::vector<uint8_t> CwcKey;
     double LastRefreshTime;
+
+    // Used to check the first datagram from a new address decrypts with this
+    // auth states key before we create a connection for it. Created on demand.
+    std::shared_ptr<Cipher> AdmissionCipher;
+};
+
+// Each shard owns a socket listening on the game port and the clients whose
+// datagrams arrive on it. Normally there is a single shard which is polled on
+// the main thread. On linux, when GameServerShardCount is greater than 1, each shard
+// opens its own SO_REUSEPORT socket (so the kernel spreads clients between them) and 
+// is polled on its own thread. Sharding is linux only, other platforms always run
+// a single shard.
+
+struct GameServiceShard
+{
+    size_t Index = 0;
+
+    std::shared_ptr<NetConnectionUDP> Connection;
+
+    std::vector<std::shared_ptr<GameClient>> Clients;
+    std::vector<std::shared_ptr<GameClient>> DisconnectingClients;
+
+    // Client timeouts and retransmits, only touched by the thread polling the shard.
+    TimerWheel Timers;
+
+    // Only used by threaded shards, the non-threaded shard uses the servers event loop.
+    std::unique_ptr<NetEventLoop> EventLoop;
+    std::thread Thread;
 };
 
 // The game server is responsible for responding to any requests that game clients make. 
@@ -49,6 +86,7 @@ public:
     virtual bool Init() override;
     virtual bool Term() override;
     virtual void Poll() override;
+    virtual double GetNextPollTime() override;
 
     virtual std::string GetName() override;
 
@@ -73,30 +111,89 @@ public:
         return nullptr;
     }
 
+    // Client lookups go through the client registry's indexes. The returned lists reference
+    // the registry directly and are only valid while the state mutex is held, so the list 
+    // getters don't lock it themselves, callers must already hold GetStateMutex().
     std::shared_ptr<GameClient> FindClientByPlayerId(uint32_t PlayerId);
-    std::vector<std::shared_ptr<GameClient>> FindClients(std::function<bool(const std::shared_ptr<GameClient>&)> Predicate);
-    std::vector<std::shared_ptr<GameClient>> GetClients() { return Clients; }
+    std::shared_ptr<GameClient> FindClientBySteamId(const std::string& SteamId);
+    const std::vector<std::shared_ptr<GameClient>>& GetClientsInArea(OnlineAreaId Area);
+    const std::vector<std::shared_ptr<GameClient>>& GetClientsInVisitorPool(Frpg2RequestMessage::VisitorPool Pool);
+    const std::vector<std::shared_ptr<GameClient>>& GetClients();
+
+    // Safe to call without holding the state mutex.
+    size_t GetClientCount();
+
+    // Should be called whenever a clients player id, steam id, area or visitor
+    // pool changes so it can be found by its new values.
+    void UpdateClientIndexes(GameClient* Client);
+
+    // Wakes up whatever is polling the given shard. Needs calling when clients are sent 
+    // messages from outside of the shards own poll, otherwise they may not go out until
+    // the shard next wakes up.
+    void WakeShard(size_t ShardIndex);
+
+    // Combined statistics of all shard connections.
+    NetConnectionUDPStatistics GetConnectionStatistics();
+
+    // Lock that guards all state shared between clients (client list, managers, auth states, etc). 
+    // Message handling and manager polling run with this held, code outside the game service
+    // that wants to inspect clients should hold it as well.
+    std::recursive_mutex& GetStateMutex() { return StateMutex; }
+
+    // Compressed payloads of messages sent to lots of clients, shared by all client streams.
+    Frpg2ReliableUdpPayloadCache& GetPayloadCache() { return PayloadCache; }
+
+    // Routes recieved messages to the managers that handle them. Dispatching and 
+    // reading its statistics should be done with the state mutex held.
+    GameMessageDispatcher& GetMessageDispatcher() { return MessageDispatcher; }
 
 protected:
 
-    void HandleClientConnection(std::shared_ptr<NetConnection> ClientConnection);
+    void HandleClientConnection(GameServiceShard& Shard, std::shared_ptr<NetConnection> ClientConnection);
+
+    // Called by the shard connections for the first datagram from an unknown address, returns
+    // true if it carries a valid auth token and decrypts with its key.
+    bool AdmitConnection(const NetIPAddress& Address, const uint8_t* Data, int Length);
+
+    void PollShard(GameServiceShard& Shard);
+    void RunShard(GameServiceShard& Shard);
+
+    // Earliest time any of the shards timers or clients need polling.
+    double GetShardNextPollTime(GameServiceShard& Shard);
 
     void TrimDatabase();
 
+    void ScheduleAuthTokenExpiry(uint64_t AuthToken, double Deadline);
+    void ScheduleClientTimeout(GameServiceShard& Shard, std::shared_ptr<GameClient> Client, double Deadline);
+
 private:
     Server* ServerInstance;
 
-    std::shared_ptr<NetConnectionUDP> Connection;
+    std::vector<std::unique_ptr<GameServiceShard>> Shards;
+    bool bThreadedShards = false;
+    std::atomic<bool> bShardsQuitting = false;
 
-    std::vector<std::shared_ptr<GameClient>> Clients;
-    std::vector<std::shared_ptr<GameClient>> DisconnectingClients;
+    std::recursive_mutex StateMutex;
+
+    // All connected clients across all shards.
+    GameClientRegistry ClientRegistry;
 
     std::vector<std::shared_ptr<GameManager>> Managers;
 
     std::unordered_map<uint64_t, GameClientAuthenticationState> AuthenticationStates;
 
+    // Auth state expiry, guarded by StateMutex.
+    TimerWheel Timers;
+
+    // Scratch space for trial decrypts in AdmitConnection, guarded by StateMutex.
+    std::vector<uint8_t> AdmissionBuffer;
+
     RSAKeyPair* ServerRSAKey;
 
+    Frpg2ReliableUdpPayloadCache PayloadCache;
+
+    GameMessageDispatcher MessageDispatcher;
+
     double NextDatabaseTrim = 0.0f;
 
 };
\ No newline at end of file
@@ -107,6 +107,11 @@ bool LoginClient::Poll()
     return false;
 }
 
+double LoginClient::GetTimeoutTime()
+{
+    return LastMessageRecievedTime + BuildConfig::CLIENT_TIMEOUT;
+}
+
 std::string LoginClient::GetName()
 {
     return Connection->GetName();
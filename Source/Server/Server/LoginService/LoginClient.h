@@ -28,6 +28,9 @@ public:
     // If this returns true the client is expected to be disconnected and is disposed of.
     bool Poll();
 
+    // Time at which the client will time out if it doesn't send anything else.
+    double GetTimeoutTime();
+
     std::string GetName();
 
 private:    
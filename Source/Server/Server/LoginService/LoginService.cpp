@@ -38,6 +38,7 @@ bool LoginService::Init()
         Error("Login service failed to listen on port %i.", Port);
         return false;
     }
+    Connection->SetEventLoop(&ServerInstance->GetEventLoop());
 
     Log("Login service is now listening on port %i.", Port);
 
@@ -81,6 +82,23 @@ void LoginService::HandleClientConnection(std::shared_ptr<NetConnection> ClientC
     Clients.push_back(Client);
 }
 
+double LoginService::GetNextPollTime()
+{
+    // Clients sockets wake us when they have data to recieve or queued data can be sent,
+    // so the only thing we need to wake up for ourselves is the next client timing out.
+    double NextPollTime = GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+    for (auto& Client : Clients)
+    {
+        double TimeoutTime = Client->GetTimeoutTime();
+        if (TimeoutTime < NextPollTime)
+        {
+            NextPollTime = TimeoutTime;
+        }
+    }
+
+    return NextPollTime;
+}
+
 std::string LoginService::GetName()
 {
     return "Login";
@@ -39,6 +39,7 @@ public:
     virtual bool Init() override;
     virtual bool Term() override;
     virtual void Poll() override;
+    virtual double GetNextPollTime() override;
 
     virtual std::string GetName() override;
 
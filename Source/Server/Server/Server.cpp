@@ -19,6 +19,7 @@
 #include "Core/Utils/Strings.h"
 #include "Core/Network/NetUtils.h"
 #include "Core/Network/NetHttpRequest.h"
+#include "Config/BuildConfig.h"
 
 #include <thread>
 #include <chrono>
@@ -43,6 +44,7 @@ Server::Server()
     CtrlSignalHandle = PlatformEvents::OnCtrlSignal.Register([=]() {
         Warning("Quit signal recieved, starting shutdown.");        
         QuitRecieved = true;
+        EventLoop.Wake();
     });
 
     // Register all services we want to run.
@@ -182,6 +184,12 @@ bool Server::Init()
         return false;
     }
 
+    if (!EventLoop.Init())
+    {
+        Error("Failed to initialize event loop.");
+        return false;
+    }
+
     // Initialize all our services.
     for (auto& Service : Services)
     {
@@ -210,6 +218,8 @@ bool Server::Term()
         }
     }
 
+    EventLoop.Term();
+
     if (!Database.Close())
     {
         Error("Failed to close database.");
@@ -316,7 +326,7 @@ void Server::PollServerAdvertisement()
         Body["Description"] = Config.ServerDescription;
         Body["Name"] = Config.ServerName;
         Body["PublicKey"] = PrimaryKeyPair.GetPublicString();
-        Body["PlayerCount"] = (int)GetService<GameService>()->GetClients().size();
+        Body["PlayerCount"] = (int)GetService<GameService>()->GetClientCount();
         Body["Password"] = Config.Password;
         Body["ModsWhiteList"] = Config.ModsWhitelist;
         Body["ModsBlackList"] = Config.ModsBlacklist;
@@ -334,12 +344,27 @@ void Server::PollServerAdvertisement()
     }
 }
 
+double Server::GetNextServerAdvertisementTime()
+{
+    if (!Config.Advertise)
+    {
+        return GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+    }
+
+    // The requests sockets aren't part of our event loop, so check back on it periodically
+    // until it finishes. Nothing is waiting on the result so this doesn't need to be prompt.
+    if (MasterServerUpdateRequest)
+    {
+        return GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+    }
+
+    return LastMasterServerUpdate + Config.AdvertiseHearbeatTime;
+}
+
 void Server::RunUntilQuit()
 {
     Success("Server is now running.");
 
-    // We should really do this event driven ...
-    // This suffices for now.
     while (!QuitRecieved)
     {
         double StartTime = GetSeconds();
@@ -353,7 +378,19 @@ void Server::RunUntilQuit()
 
         UpdateTime = GetSeconds() - StartTime;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Sleep until one of the services sockets has data for us, or
+        // until something is next due to happen.
+        double NextPollTime = GetNextServerAdvertisementTime();
+        for (auto& Service : Services)
+        {
+            double ServicePollTime = Service->GetNextPollTime();
+            if (ServicePollTime < NextPollTime)
+            {
+                NextPollTime = ServicePollTime;
+            }
+        }
+
+        EventLoop.Wait(NextPollTime);
     }
 }
 
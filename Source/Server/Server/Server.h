@@ -20,6 +20,7 @@
 #include "Core/Crypto/RSAKeyPair.h"
 
 #include "Core/Network/NetIPAddress.h"
+#include "Core/Network/NetEventLoop.h"
 
 #include "Config/RuntimeConfig.h"
 
@@ -45,6 +46,7 @@ public:
     const RuntimeConfig& GetConfig()    { return Config; }
     RuntimeConfig& GetMutableConfig()   { return Config; }
     ServerDatabase& GetDatabase()       { return Database; }
+    NetEventLoop& GetEventLoop()        { return EventLoop; }
 
     NetIPAddress GetPublicIP()          { return PublicIP; }
     NetIPAddress GetPrivateIP()         { return PrivateIP; }
@@ -69,6 +71,7 @@ protected:
 
     void CancelServerAdvertisement();
     void PollServerAdvertisement();
+    double GetNextServerAdvertisementTime();
     bool ParseServerAdvertisementResponse(std::shared_ptr<NetHttpResponse> Response, nlohmann::json& json);
 
 private:
@@ -83,6 +86,8 @@ private:
 
     ServerDatabase Database;
 
+    NetEventLoop EventLoop;
+
     std::filesystem::path SavedPath;
     std::filesystem::path ConfigPath;
     std::filesystem::path PrivateKeyPath;
@@ -23,6 +23,11 @@ public:
     virtual bool Term() = 0;
     virtual void Poll() = 0;
 
+    // Gets the time (as returned by GetSeconds) at which this service next 
+    // needs to be polled. The server will sleep until this time unless one 
+    // of the services sockets wakes it up sooner.
+    virtual double GetNextPollTime() = 0;
+
     virtual std::string GetName() = 0;
 
 };
\ No newline at end of file
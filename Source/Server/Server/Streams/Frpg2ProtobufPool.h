@@ -0,0 +1,149 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+
+#include "Config/BuildConfig.h"
+
+#include "Protobuf/Protobufs.h"
+
+// Every recieved message is parsed into a protobuf instance that only lives until the
+// message has been handled. Rather than allocating a fresh instance (and all of its
+// nested messages, repeated fields and strings) for each one, instances are taken from
+// a pool and cleared and returned to it when the last reference to them is released.
+// Protobufs keep the storage of their sub-messages and repeated fields when cleared,
+// so a reused instance can normally be parsed into without allocating at all.
+//
+// Pools are per-thread, so each game service shard gets its own and no locking is
+// required. An instance released on a different thread to the one that acquired it
+// ends up in the releasing thread's pool, or is freed if that thread has none.
+
+struct Frpg2ProtobufPoolStatistics
+{
+    // Number of instances that had to be allocated as the pool was empty.
+    size_t Allocations = 0;
+
+    // Number of instances handed out from the pool rather than allocated.
+    size_t Reuses = 0;
+
+    // Number of instances currently sitting unused in pools.
+    size_t Pooled = 0;
+};
+
+class Frpg2ProtobufPool
+{
+public:
+
+    // Gets a cleared instance of the given protobuf class, it will be returned to
+    // the pool when the last reference to it is released.
+    template <typename ProtobufClass>
+    static std::shared_ptr<google::protobuf::MessageLite> Acquire()
+    {
+        FreeList<ProtobufClass>& List = GetFreeList<ProtobufClass>();
+
+        ProtobufClass* Instance = nullptr;
+        if (!List.Instances.empty())
+        {
+            Instance = List.Instances.back();
+            List.Instances.pop_back();
+
+            Reuses++;
+            Pooled--;
+        }
+        else
+        {
+            Instance = new ProtobufClass();
+
+            Allocations++;
+        }
+
+        return std::shared_ptr<google::protobuf::MessageLite>(Instance, &Release<ProtobufClass>);
+    }
+
+    static Frpg2ProtobufPoolStatistics GetStatistics()
+    {
+        Frpg2ProtobufPoolStatistics Result;
+        Result.Allocations = Allocations;
+        Result.Reuses = Reuses;
+        Result.Pooled = Pooled;
+        return Result;
+    }
+
+private:
+
+    template <typename ProtobufClass>
+    struct FreeList
+    {
+        std::vector<ProtobufClass*> Instances;
+
+        FreeList()
+        {
+            GetFreeListAlive<ProtobufClass>() = true;
+        }
+
+        ~FreeList()
+        {
+            GetFreeListAlive<ProtobufClass>() = false;
+
+            Pooled -= Instances.size();
+            for (ProtobufClass* Instance : Instances)
+            {
+                delete Instance;
+            }
+        }
+    };
+
+    template <typename ProtobufClass>
+    static FreeList<ProtobufClass>& GetFreeList()
+    {
+        thread_local FreeList<ProtobufClass> List;
+        return List;
+    }
+
+    // Instances released while a thread is exiting may outlive its free list, this is
+    // trivially destructible so it remains valid for the lifetime of the thread.
+    template <typename ProtobufClass>
+    static bool& GetFreeListAlive()
+    {
+        thread_local bool Alive = false;
+        return Alive;
+    }
+
+    template <typename ProtobufClass>
+    static void Release(google::protobuf::MessageLite* Message)
+    {
+        ProtobufClass* Instance = static_cast<ProtobufClass*>(Message);
+
+        if (GetFreeListAlive<ProtobufClass>())
+        {
+            FreeList<ProtobufClass>& List = GetFreeList<ProtobufClass>();
+            if (List.Instances.size() < BuildConfig::PROTOBUF_POOL_MAX_FREE_PER_TYPE)
+            {
+                Instance->Clear();
+                List.Instances.push_back(Instance);
+
+                Pooled++;
+                return;
+            }
+        }
+
+        delete Instance;
+    }
+
+private:
+    inline static std::atomic<size_t> Allocations = 0;
+    inline static std::atomic<size_t> Reuses = 0;
+    inline static std::atomic<size_t> Pooled = 0;
+
+};
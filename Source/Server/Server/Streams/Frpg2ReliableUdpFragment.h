@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Core/Utils/Endian.h"
+#include "Core/Utils/PacketBuffer.h"
 
 #include <vector>
 
@@ -51,7 +52,10 @@ public:
    
     // Length of this payload should be the same
     // as the value stored in Header.payload_length
-    std::vector<uint8_t> Payload;
+    PacketBuffer Payload;
+
+    // Compressed payload should be looked up in/stored in the streams payload cache.
+    bool Cacheable = false;
 
     std::string Disassembly;
 
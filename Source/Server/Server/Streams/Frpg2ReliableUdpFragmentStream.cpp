@@ -9,6 +9,7 @@
 
 #include "Server/Streams/Frpg2ReliableUdpFragmentStream.h"
 #include "Server/Streams/Frpg2ReliableUdpFragment.h"
+#include "Server/Streams/Frpg2ReliableUdpPayloadCache.h"
 
 #include "Config/BuildConfig.h"
 
@@ -25,44 +26,82 @@
 Frpg2ReliableUdpFragmentStream::Frpg2ReliableUdpFragmentStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient)
     : Frpg2ReliableUdpPacketStream(Connection, CwcKey, AuthToken, AsClient)
 {
+    ReassemblyTable.resize(MAX_REASSEMBLY_ENTRIES);
 }
 
-bool Frpg2ReliableUdpFragmentStream::Send(const Frpg2ReliableUdpFragment& Fragment)
+bool Frpg2ReliableUdpFragmentStream::Send(Frpg2ReliableUdpFragment& Fragment)
 {
-    std::vector<uint8_t> Payload = Fragment.Payload;
-    bool bCompressed = (Fragment.Payload.size() >= MIN_SIZE_FOR_COMPRESSION);
-    uint32_t UncompressedSize = (uint32_t)Payload.size();
+    bool bCompressed = (Fragment.Payload.Size() >= MIN_SIZE_FOR_COMPRESSION);
+    uint32_t UncompressedSize = (uint32_t)Fragment.Payload.Size();
 
-    if (bCompressed)
+    const uint8_t* Payload = Fragment.Payload.Data();
+    size_t PayloadSize = Fragment.Payload.Size();
+
+    // Keeps the cache entry alive while we are fragmenting it.
+    Frpg2ReliableUdpPayloadCache::CompressedPayload CachedPayload;
+
+    // Uncached payloads are compressed straight into a packet buffer, so if they fit in
+    // a single fragment the buffer can be sent on as-is.
+    PacketBuffer CompressedPayload;
+
+    if (bCompressed && Fragment.Cacheable && PayloadCache != nullptr)
+    {
+        CachedPayload = PayloadCache->GetCompressed(Fragment.Payload.Data(), Fragment.Payload.Size());
+        if (!CachedPayload)
+        {
+            WarningS(Connection->GetName().c_str(), "Failed to compress packet data.");
+            InErrorState = true;
+            return false;
+        }
+
+        Payload = CachedPayload->data();
+        PayloadSize = CachedPayload->size();
+    }
+    else if (bCompressed)
     {        
-        std::vector<uint8_t> UncompressPayload = Payload;
-        if (!Compress(UncompressPayload, Payload))
+        if (!Compress(Fragment.Payload.Data(), Fragment.Payload.Size(), CompressedPayload))
         {
             WarningS(Connection->GetName().c_str(), "Failed to compress packet data.");
             InErrorState = true;
             return false;
         }
+
+        Payload = CompressedPayload.Data();
+        PayloadSize = CompressedPayload.Size();
     }
 
-    size_t FragmentCount = (Payload.size() + (MAX_FRAGMENT_LENGTH - 1)) / MAX_FRAGMENT_LENGTH;
+    size_t FragmentCount = (PayloadSize + (MAX_FRAGMENT_LENGTH - 1)) / MAX_FRAGMENT_LENGTH;
 
     // Fragment up if payload is larger than max payload size.
     for (size_t i = 0; i < FragmentCount; i++)
     {
         int FragmentOffset = (int)i * MAX_FRAGMENT_LENGTH;
-        int BytesRemaining = (int)Payload.size() - FragmentOffset;
+        int BytesRemaining = (int)PayloadSize - FragmentOffset;
         int FragmentLength = std::min(MAX_FRAGMENT_LENGTH, BytesRemaining);
 
         Frpg2ReliableUdpFragment SendFragment;
         SendFragment.Header.compress_flag = bCompressed;
         SendFragment.Header.fragment_index = (uint8_t)i;
         SendFragment.Header.fragment_length = FragmentLength;
-        SendFragment.Header.total_payload_length = (uint16_t)Payload.size();
+        SendFragment.Header.total_payload_length = (uint16_t)PayloadSize;
         SendFragment.Header.packet_counter = SentFragmentCounter;
         SendFragment.PayloadDecompressedLength = UncompressedSize;
-        SendFragment.Payload.resize(FragmentLength);
 
-        memcpy(SendFragment.Payload.data(), Payload.data() + FragmentOffset, FragmentLength);
+        // If the payload goes out in a single fragment we can reuse its buffer, otherwise each
+        // fragment has to be copied into its own buffer so it has room for its headers. Cached
+        // payloads are shared with other streams so are always copied.
+        if (!bCompressed && FragmentCount == 1)
+        {
+            SendFragment.Payload = std::move(Fragment.Payload);
+        }
+        else if (!CompressedPayload.Empty() && FragmentCount == 1)
+        {
+            SendFragment.Payload = std::move(CompressedPayload);
+        }
+        else
+        {
+            SendFragment.Payload = PacketBuffer(Payload + FragmentOffset, FragmentLength);
+        }
 
         Frpg2ReliableUdpPacket SendPacket;
         if (!EncodeFragment(SendFragment, SendPacket))
@@ -104,7 +143,7 @@ bool Frpg2ReliableUdpFragmentStream::Recieve(Frpg2ReliableUdpFragment* Fragment)
 {
     if (RecieveQueue.size() > 0)
     {
-        *Fragment = RecieveQueue[0];
+        *Fragment = std::move(RecieveQueue[0]);
         RecieveQueue.erase(RecieveQueue.begin());
         return true;
     }
@@ -142,58 +181,57 @@ bool Frpg2ReliableUdpFragmentStream::RecieveInternal(Frpg2ReliableUdpFragment* F
 
 bool Frpg2ReliableUdpFragmentStream::DecodeFragment(const Frpg2ReliableUdpPacket& Packet, Frpg2ReliableUdpFragment& Fragment)
 {
-    if (Packet.Payload.size() < sizeof(Frpg2ReliableUdpFragmentHeader))
+    if (Packet.Payload.Size() < sizeof(Frpg2ReliableUdpFragmentHeader))
     {
         WarningS(Connection->GetName().c_str(), "Packet payload is less than the minimum size of a Fragment, failed to deserialize.");
         InErrorState = true;
         return false;
     }
 
-    memcpy(&Fragment.Header, Packet.Payload.data(), sizeof(Frpg2ReliableUdpFragmentHeader));
+    memcpy(&Fragment.Header, Packet.Payload.Data(), sizeof(Frpg2ReliableUdpFragmentHeader));
     Fragment.Header.SwapEndian();
 
-    size_t PayloadOffset = sizeof(Frpg2ReliableUdpFragmentHeader);
-    size_t PayloadLength = Packet.Payload.size() - PayloadOffset;
+    // Fragment shares the packets buffer, headers are just stripped off the front.
+    Fragment.Payload = Packet.Payload;
+    Fragment.Payload.Strip(sizeof(Frpg2ReliableUdpFragmentHeader));
 
     if (Fragment.Header.compress_flag && Fragment.Header.fragment_index == 0)
     {
-        memcpy(&Fragment.PayloadDecompressedLength, Packet.Payload.data() + PayloadOffset, 4);
+        if (Fragment.Payload.Size() < 4)
+        {
+            WarningS(Connection->GetName().c_str(), "Packet payload is too small to contain decompressed length, failed to deserialize.");
+            InErrorState = true;
+            return false;
+        }
+
+        memcpy(&Fragment.PayloadDecompressedLength, Fragment.Payload.Data(), 4);
         Fragment.PayloadDecompressedLength = BigEndianToHostOrder(Fragment.PayloadDecompressedLength);
 
-        PayloadOffset += 4;
-        PayloadLength -= 4;
+        Fragment.Payload.Strip(4);
     }
 
-    Fragment.Payload.resize(PayloadLength);
-    memcpy(Fragment.Payload.data(), Packet.Payload.data() + PayloadOffset, PayloadLength);
-
     return true;
 }
 
-bool Frpg2ReliableUdpFragmentStream::EncodeFragment(const Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet)
+bool Frpg2ReliableUdpFragmentStream::EncodeFragment(Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet)
 {
-    Frpg2ReliableUdpFragment ByteSwappedFragment = Fragment;
-    ByteSwappedFragment.Header.SwapEndian();
-    ByteSwappedFragment.PayloadDecompressedLength = HostOrderToBigEndian(ByteSwappedFragment.PayloadDecompressedLength);
+    Frpg2ReliableUdpFragmentHeader ByteSwappedHeader = Fragment.Header;
+    ByteSwappedHeader.SwapEndian();
 
-    size_t PayloadSize = sizeof(Frpg2ReliableUdpFragmentHeader) + ByteSwappedFragment.Payload.size();
-    if (ByteSwappedFragment.Header.compress_flag && ByteSwappedFragment.Header.fragment_index == 0)
-    {
-        PayloadSize += 4;
-    }
-
-    Packet.Payload.resize(PayloadSize);
+    // Headers are prepended into the payloads headroom, in reverse order. The payload is 
+    // taken from the fragment, nothing else can be referencing it as the packet stream 
+    // encrypts it in place.
+    Packet.Payload = std::move(Fragment.Payload);
 
-    memcpy(Packet.Payload.data(), &ByteSwappedFragment.Header, sizeof(Frpg2ReliableUdpFragmentHeader));
+    Ensure(!Packet.Payload.IsShared());
 
-    size_t WriteOffset = sizeof(Frpg2ReliableUdpFragmentHeader);
-    if (ByteSwappedFragment.Header.compress_flag && ByteSwappedFragment.Header.fragment_index == 0)
+    if (Fragment.Header.compress_flag && Fragment.Header.fragment_index == 0)
     {
-        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedFragment.PayloadDecompressedLength, 4);
-        WriteOffset += 4;
+        uint32_t ByteSwappedDecompressedLength = HostOrderToBigEndian(Fragment.PayloadDecompressedLength);
+        memcpy(Packet.Payload.Prepend(4), &ByteSwappedDecompressedLength, 4);
     }
 
-    memcpy(Packet.Payload.data() + WriteOffset, ByteSwappedFragment.Payload.data(), ByteSwappedFragment.Payload.size());
+    memcpy(Packet.Payload.Prepend(sizeof(Frpg2ReliableUdpFragmentHeader)), &ByteSwappedHeader, sizeof(Frpg2ReliableUdpFragmentHeader));
 
     return true;
 }
@@ -202,9 +240,12 @@ void Frpg2ReliableUdpFragmentStream::Reset()
 {
     Frpg2ReliableUdpPacketStream::Reset();
 
-    Fragments.clear();
+    for (ReassemblyEntry& Entry : ReassemblyTable)
+    {
+        Entry.InUse = false;
+        Entry.First = Frpg2ReliableUdpFragment();
+    }
     RecieveQueue.clear();
-    RecievedFragmentLength = 0;
 }
 
 bool Frpg2ReliableUdpFragmentStream::Pump()
@@ -214,69 +255,159 @@ bool Frpg2ReliableUdpFragmentStream::Pump()
         return true;
     }
 
-    // TODO: I have the horrible feeling the client multiplex's fragments from different packets.
-    //       If this is the case we need to check the packet_counter when defragmenting packets and keep them together.
-
     Frpg2ReliableUdpFragment Fragment;
     while (RecieveInternal(&Fragment))
     {
-        RecievedFragmentLength += Fragment.Header.fragment_length;
-        if (RecievedFragmentLength >= Fragment.Header.total_payload_length)
+        Frpg2ReliableUdpFragment Combined;
+        if (!ReassembleFragment(Fragment, Combined))
         {
-            // Compact all payloads together into one combined packet.
-            if (Fragments.size() > 0)
+            if (InErrorState)
             {
-                Frpg2ReliableUdpFragment CombinedFragment = Fragments[0];
-                CombinedFragment.AckSequenceIndex = Fragment.AckSequenceIndex; // Ack the last packet in the fragment list.
-                CombinedFragment.Header.fragment_index = 0;
-                CombinedFragment.Header.fragment_length = Fragment.Header.total_payload_length;
-
-                CombinedFragment.Payload.resize(CombinedFragment.Header.total_payload_length);
-                int Offset = Fragments[0].Header.fragment_length;
-                for (int i = 1; i < Fragments.size(); i++)
-                {
-                    const Frpg2ReliableUdpFragment& Fragment = Fragments[i];
-                    memcpy(CombinedFragment.Payload.data() + Offset, Fragment.Payload.data(), Fragment.Payload.size());
-                    Offset += (int)Fragment.Payload.size();
-                }
-
-                memcpy(CombinedFragment.Payload.data() + Offset, Fragment.Payload.data(), Fragment.Payload.size());
-
-                Fragment = CombinedFragment;
+                return true;
             }
+            continue;
+        }
 
-            // Decompress data if required.
-            if (Fragment.Header.compress_flag)
+        // Decompress data if required, fragments that needed reassembling will already
+        // have been decompressed straight out of the reassembly buffer.
+        if (Combined.Header.compress_flag)
+        {
+            if (!DecompressFragment(Combined, Combined.Payload.Data(), Combined.Payload.Size()))
             {
-                std::vector<uint8_t> UncompressPayload = Fragment.Payload;
-                if (!Decompress(UncompressPayload, Fragment.Payload, Fragment.PayloadDecompressedLength))
-                {
-                    WarningS(Connection->GetName().c_str(), "Failed to decompress packet data.");
-                    InErrorState = true;
-                    return true;
-                }
-
-                Fragment.Header.compress_flag = false;
+                return true;
             }
+        }
 
-            // Disassemble if required.
-            if constexpr (BuildConfig::DISASSEMBLE_RECIEVED_MESSAGES)
-            {
-                Fragment.Disassembly.append(Disassemble(Fragment));
-            }
+        // Disassemble if required.
+        if constexpr (BuildConfig::DISASSEMBLE_RECIEVED_MESSAGES)
+        {
+            Combined.Disassembly.append(Disassemble(Combined));
+        }
+
+        RecieveQueue.push_back(std::move(Combined));
+    }
+
+    return false;
+}
 
-            RecieveQueue.push_back(Fragment);
+bool Frpg2ReliableUdpFragmentStream::ReassembleFragment(Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpFragment& Output)
+{
+    uint16_t PacketCounter = Fragment.Header.packet_counter;
 
-            Fragments.clear();
-            RecievedFragmentLength = 0;
+    ReassemblyEntry* Entry = nullptr;
+    ReassemblyEntry* FreeEntry = nullptr;
+    for (ReassemblyEntry& Existing : ReassemblyTable)
+    {
+        if (Existing.InUse && Existing.PacketCounter == PacketCounter)
+        {
+            Entry = &Existing;
+            break;
         }
-        else
+        else if (!Existing.InUse && FreeEntry == nullptr)
         {
-            Fragments.push_back(Fragment);
+            FreeEntry = &Existing;
         }
     }
 
-    return false;
+    if (Entry == nullptr)
+    {
+        if (Fragment.Header.fragment_index != 0)
+        {
+            WarningS(Connection->GetName().c_str(), "Recieved fragment %i of packet %i without recieving its first fragment.", Fragment.Header.fragment_index, PacketCounter);
+            InErrorState = true;
+            return false;
+        }
+
+        // Most packets are a single fragment, these can be passed straight through without copying.
+        if (Fragment.Payload.Size() >= Fragment.Header.total_payload_length)
+        {
+            Output = std::move(Fragment);
+            return true;
+        }
+
+        if (FreeEntry == nullptr)
+        {
+            WarningS(Connection->GetName().c_str(), "Too many fragmented packets being recieved at once, failed to reassemble packet %i.", PacketCounter);
+            InErrorState = true;
+            return false;
+        }
+
+        Entry = FreeEntry;
+        Entry->InUse = true;
+        Entry->PacketCounter = PacketCounter;
+        Entry->NextFragmentIndex = 0;
+        Entry->RecievedLength = 0;
+        Entry->Buffer.resize(Fragment.Header.total_payload_length);
+    }
+
+    // The reliable packet stream only passes packets up in sequence order (out of order ones wait
+    // in its reorder buffer), so fragments always arrive in order and can be appended as they come.
+    // Anything else means the stream is broken rather than the fragments just being reordered.
+    if (Fragment.Header.fragment_index != Entry->NextFragmentIndex)
+    {
+        WarningS(Connection->GetName().c_str(), "Recieved fragment %i of packet %i out of order, expected fragment %i.", Fragment.Header.fragment_index, PacketCounter, Entry->NextFragmentIndex);
+        InErrorState = true;
+        return false;
+    }
+
+    if (Entry->RecievedLength + Fragment.Payload.Size() > Entry->Buffer.size())
+    {
+        WarningS(Connection->GetName().c_str(), "Fragments of packet %i are larger than its total payload length (%i).", PacketCounter, (int)Entry->Buffer.size());
+        InErrorState = true;
+        return false;
+    }
+
+    memcpy(Entry->Buffer.data() + Entry->RecievedLength, Fragment.Payload.Data(), Fragment.Payload.Size());
+    Entry->RecievedLength += (uint32_t)Fragment.Payload.Size();
+    Entry->NextFragmentIndex++;
+
+    if (Fragment.Header.fragment_index == 0)
+    {
+        Entry->First = std::move(Fragment);
+        Entry->First.Payload = PacketBuffer();
+        return false;
+    }
+
+    if (Entry->RecievedLength < Entry->Buffer.size())
+    {
+        return false;
+    }
+
+    Output = std::move(Entry->First);
+    Output.AckSequenceIndex = Fragment.AckSequenceIndex; // Ack the last packet in the fragment list.
+    Output.Header.fragment_index = 0;
+    Output.Header.fragment_length = Output.Header.total_payload_length;
+
+    Entry->InUse = false;
+    Entry->First = Frpg2ReliableUdpFragment();
+
+    // Compressed payloads are decompressed straight out of the reassembly buffer, so we 
+    // can keep hold of it for the next packet. Otherwise the payload takes the buffer over.
+    if (Output.Header.compress_flag)
+    {
+        return DecompressFragment(Output, Entry->Buffer.data(), Entry->Buffer.size());
+    }
+
+    Output.Payload = PacketBuffer(std::move(Entry->Buffer));
+    Entry->Buffer = std::vector<uint8_t>();
+
+    return true;
+}
+
+bool Frpg2ReliableUdpFragmentStream::DecompressFragment(Frpg2ReliableUdpFragment& Fragment, const uint8_t* Data, size_t Size)
+{
+    std::vector<uint8_t> UncompressedPayload;
+    if (!Decompress(Data, Size, UncompressedPayload, Fragment.PayloadDecompressedLength))
+    {
+        WarningS(Connection->GetName().c_str(), "Failed to decompress packet data.");
+        InErrorState = true;
+        return false;
+    }
+
+    Fragment.Payload = PacketBuffer(std::move(UncompressedPayload));
+    Fragment.Header.compress_flag = false;
+
+    return true;
 }
 
 std::string Frpg2ReliableUdpFragmentStream::Disassemble(const Frpg2ReliableUdpFragment& Packet)
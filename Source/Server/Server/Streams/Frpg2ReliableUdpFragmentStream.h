@@ -14,6 +14,7 @@
 
 class RSAKeyPair;
 class Cipher;
+class Frpg2ReliableUdpPayloadCache;
 
 class Frpg2ReliableUdpFragmentStream
     : public Frpg2ReliableUdpPacketStream
@@ -22,8 +23,9 @@ public:
     Frpg2ReliableUdpFragmentStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient = false);
 
     // Returns true if send was successful, if false is returned the send queue
-    // is likely saturated or the packet is invalid.
-    virtual bool Send(const Frpg2ReliableUdpFragment& Fragment);
+    // is likely saturated or the packet is invalid. The fragments payload may be 
+    // handed down to the packet stream, so it shouldn't be used afterwards.
+    virtual bool Send(Frpg2ReliableUdpFragment& Fragment);
 
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     virtual bool Recieve(Frpg2ReliableUdpFragment* Fragment);
@@ -34,27 +36,60 @@ public:
     // Diassembles a messages into a human-readable string.
     std::string Disassemble(const Frpg2ReliableUdpFragment& Packet);
 
+    // Cache used to avoid recompressing cacheable fragments, if not set 
+    // cacheable fragments are compressed like any other.
+    void SetPayloadCache(Frpg2ReliableUdpPayloadCache* InPayloadCache) { PayloadCache = InPayloadCache; }
+
 protected:
 
     virtual bool RecieveInternal(Frpg2ReliableUdpFragment* Fragment);
 
+    // Adds a recieved fragment to the reassembly table, returns true and stores the 
+    // combined fragment in Output once all fragments of its packet have been recieved.
+    bool ReassembleFragment(Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpFragment& Output);
+
+    // Decompresses the given data into the fragments payload.
+    bool DecompressFragment(Frpg2ReliableUdpFragment& Fragment, const uint8_t* Data, size_t Size);
+
     bool DecodeFragment(const Frpg2ReliableUdpPacket& Packet, Frpg2ReliableUdpFragment& Fragment);
-    bool EncodeFragment(const Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet);
+    bool EncodeFragment(Frpg2ReliableUdpFragment& Fragment, Frpg2ReliableUdpPacket& Packet);
 
     virtual void Reset() override;
 
 private:
 
-    std::vector<Frpg2ReliableUdpFragment> Fragments;
-    uint32_t RecievedFragmentLength = 0;
+    // Packet whose fragments are in the process of being recieved. Fragments of
+    // a packet arrive in order, but the client can interleave fragments of 
+    // different packets, so these are keyed by packet_counter.
+    struct ReassemblyEntry
+    {
+        bool InUse = false;
+        uint16_t PacketCounter = 0;
+        uint8_t NextFragmentIndex = 0;
+        uint32_t RecievedLength = 0;
+
+        // Header/etc of the first fragment.
+        Frpg2ReliableUdpFragment First;
+
+        // Sized from total_payload_length, fragments are written straight into
+        // it. Kept around between packets so it only needs to grow occasionally.
+        std::vector<uint8_t> Buffer;
+    };
+
+    std::vector<ReassemblyEntry> ReassemblyTable;
 
     std::vector<Frpg2ReliableUdpFragment> RecieveQueue;
     
     uint32_t SentFragmentCounter = 0;
 
+    Frpg2ReliableUdpPayloadCache* PayloadCache = nullptr;
+
     // Includes header + compressed payload.
     // The main game seems to allow up to 1024, so we can boost this a bit if needed.
     const int MAX_FRAGMENT_LENGTH = 900;
     const int MIN_SIZE_FOR_COMPRESSION = 512;
 
+    // Maximum number of packets we will reassemble at the same time.
+    const int MAX_REASSEMBLY_ENTRIES = 8;
+
 };
\ No newline at end of file
@@ -8,94 +8,125 @@
  */
 
 #include "Server/Streams/Frpg2ReliableUdpMessage.h"
+#include "Server/Streams/Frpg2ProtobufPool.h"
 
-bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output)
+#include <array>
+#include <unordered_map>
+#include <typeindex>
+
+namespace
 {
-#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass) \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Type;                                 \
-        return true;                                                                \
-    }                                                                               
-#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                 \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Type;                                 \
-        return true;                                                                \
-    }                                                                               
-#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                            \
-    if (dynamic_cast<Frpg2RequestMessage::ProtobufClass*>(Message) != nullptr)      \
-    {                                                                               \
-        Output = Frpg2ReliableUdpMessageType::Push; /* Not using push */            \
-        return true;                                                                \
-    }    
+    using ProtobufFactory = std::shared_ptr<google::protobuf::MessageLite>(*)();
+
+    template <typename ProtobufClass>
+    std::shared_ptr<google::protobuf::MessageLite> CreateProtobuf()
+    {
+        return Frpg2ProtobufPool::Acquire<ProtobufClass>();
+    }
+
+    struct MessageTypeEntry
+    {
+        ProtobufFactory CreateRequest = nullptr;
+        ProtobufFactory CreateResponse = nullptr;
+        bool ExpectsResponse = false;
+    };
+
+    using MessageTypeTable = std::array<MessageTypeEntry, GetMaxReliableUdpMessageType() + 1>;
+
+    // Indexed directly by message type, so recieving a message is a single lookup.
+    constexpr MessageTypeTable BuildMessageTypeTable()
+    {
+        MessageTypeTable Table = {};
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)                     \
+        Table[OpCode].CreateRequest = &CreateProtobuf<Frpg2RequestMessage::ProtobufClass>;              \
+        Table[OpCode].CreateResponse = &CreateProtobuf<Frpg2RequestMessage::ResponseProtobufClass>;     \
+        Table[OpCode].ExpectsResponse = true;
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
+        Table[OpCode].CreateRequest = &CreateProtobuf<Frpg2RequestMessage::ProtobufClass>;
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                                /* Not supported on server, server only sends these */
 #include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
 #undef DEFINE_PUSH_MESSAGE
 #undef DEFINE_MESSAGE
 #undef DEFINE_REQUEST_RESPONSE
 
-    return false;
-}
-
-bool ReliableUdpMessageType_To_Protobuf(Frpg2ReliableUdpMessageType InType, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output)
-{
-#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)                     \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                                      \
-    {                                                                                                   \
-        if (IsResponse)                                                                                 \
-        {                                                                                               \
-            Output = std::make_shared<Frpg2RequestMessage::ResponseProtobufClass>();                    \
-        }                                                                                               \
-        else                                                                                            \
-        {                                                                                               \
-            Output = std::make_shared<Frpg2RequestMessage::ProtobufClass>();                            \
-        }                                                                                               \
-        return true;                                                                                    \
+        return Table;
     }
-#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                                      \
-    {                                                                                                   \
-        if (IsResponse)                                                                                 \
-        {                                                                                               \
-            return false;                                                                               \
-        }                                                                                               \
-        else                                                                                            \
-        {                                                                                               \
-            Output = std::make_shared<Frpg2RequestMessage::ProtobufClass>();                            \
-            return true;                                                                                \
-        }                                                                                               \
+
+    constexpr MessageTypeTable MessageTypes = BuildMessageTypeTable();
+
+    const MessageTypeEntry* FindMessageType(Frpg2ReliableUdpMessageType Type)
+    {
+        size_t Index = static_cast<size_t>(Type);
+        if (Index >= MessageTypes.size())
+        {
+            return nullptr;
+        }
+        return &MessageTypes[Index];
     }
-#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                                /* Not supported on server, server only sends these */
+
+    // Generated protobuf classes are never derived from, so the dynamic type of
+    // a message identifies its class exactly.
+    using ProtobufTypeMap = std::unordered_map<std::type_index, Frpg2ReliableUdpMessageType>;
+
+    const ProtobufTypeMap& GetProtobufTypeMap()
+    {
+        static const ProtobufTypeMap Map = []() {
+            ProtobufTypeMap Result;
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>::MessageType);
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>::MessageType);
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    Result.emplace(typeid(Frpg2RequestMessage::ProtobufClass), Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>::MessageType);
 #include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
 #undef DEFINE_PUSH_MESSAGE
 #undef DEFINE_MESSAGE
 #undef DEFINE_REQUEST_RESPONSE
 
+            return Result;
+        }();
+
+        return Map;
+    }
+};
+
+bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output)
+{
+    const ProtobufTypeMap& Map = GetProtobufTypeMap();
+    if (auto iter = Map.find(typeid(*Message)); iter != Map.end())
+    {
+        Output = iter->second;
+        return true;
+    }
+
     return false;
 }
 
-bool ReliableUdpMessageType_Expects_Response(Frpg2ReliableUdpMessageType InType)
+bool ReliableUdpMessageType_To_Protobuf(Frpg2ReliableUdpMessageType InType, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output)
 {
-    if (InType == Frpg2ReliableUdpMessageType::Push)                                        
-    {                                                                                       
-        return false;                                                                       
+    const MessageTypeEntry* Entry = FindMessageType(InType);
+    if (Entry == nullptr)
+    {
+        return false;
     }
 
-#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                        \
-    {                                                                                       \
-        return true;                                                                        \
+    ProtobufFactory Factory = IsResponse ? Entry->CreateResponse : Entry->CreateRequest;
+    if (Factory == nullptr)
+    {
+        return false;
     }
-#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         \
-    if (InType == Frpg2ReliableUdpMessageType::Type)                                        \
-    {                                                                                       \
-        return false;                                                                       \
+
+    Output = Factory();
+    return true;
+}
+
+bool ReliableUdpMessageType_Expects_Response(Frpg2ReliableUdpMessageType InType)
+{
+    // Push shares its value with RequestSendMessageToPlayers, pushes take priority.
+    if (InType == Frpg2ReliableUdpMessageType::Push)
+    {
+        return false;
     }
-#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Not required, gets caught by Push test above */
-#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
-#undef DEFINE_PUSH_MESSAGE
-#undef DEFINE_MESSAGE
-#undef DEFINE_REQUEST_RESPONSE
 
-    return false;
+    const MessageTypeEntry* Entry = FindMessageType(InType);
+    return Entry != nullptr && Entry->ExpectsResponse;
 }
@@ -10,9 +10,11 @@
 #pragma once
 
 #include "Core/Utils/Endian.h"
+#include "Core/Utils/PacketBuffer.h"
 
 #include <vector>
 #include <memory>
+#include <cstddef>
 
 #include "Protobuf/Protobufs.h"
 
@@ -78,11 +80,68 @@ public:
 
     std::shared_ptr<google::protobuf::MessageLite> Protobuf;
 
-    std::vector<uint8_t> Payload;
+    PacketBuffer Payload;
+
+    // Set if this message is sent identically to lots of clients, its compressed form
+    // will be kept in the payload cache. See Frpg2ReliableUdpPayloadCache.
+    bool Cacheable = false;
 
     std::string Disassembly;
 };
 
+// Largest message type value we can recieve, anything above this is unknown.
+constexpr size_t GetMaxReliableUdpMessageType()
+{
+    size_t Result = 0;
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)         if (OpCode > Result) { Result = OpCode; }
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                         if (OpCode > Result) { Result = OpCode; }
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                    /* Server only sends these */
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
+
+    return Result;
+}
+
+// Maps a protobuf class to the message type it is sent with, so code that knows the class
+// it is sending can resolve the type at compile time rather than looking it up at runtime.
+// Classes that are never sent as the start of a message (eg. responses) have IsMessage = false.
+template <typename ProtobufClass>
+struct Frpg2ReliableUdpMessageTypeTraits
+{
+    static constexpr bool IsMessage = false;
+};
+
+#define DEFINE_REQUEST_RESPONSE(OpCode, Type, ProtobufClass, ResponseProtobufClass)                     \
+    template <>                                                                                         \
+    struct Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>                        \
+    {                                                                                                   \
+        static constexpr bool IsMessage = true;                                                         \
+        static constexpr Frpg2ReliableUdpMessageType MessageType = Frpg2ReliableUdpMessageType::Type;   \
+    };
+#define DEFINE_MESSAGE(OpCode, Type, ProtobufClass)                                                     \
+    template <>                                                                                         \
+    struct Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>                        \
+    {                                                                                                   \
+        static constexpr bool IsMessage = true;                                                         \
+        static constexpr Frpg2ReliableUdpMessageType MessageType = Frpg2ReliableUdpMessageType::Type;   \
+    };
+#define DEFINE_PUSH_MESSAGE(OpCode, Type, ProtobufClass)                                                \
+    template <>                                                                                         \
+    struct Frpg2ReliableUdpMessageTypeTraits<Frpg2RequestMessage::ProtobufClass>                        \
+    {                                                                                                   \
+        static constexpr bool IsMessage = true;                                                         \
+        static constexpr Frpg2ReliableUdpMessageType MessageType = Frpg2ReliableUdpMessageType::Push;   \
+    };
+#include "Server/Streams/Frpg2ReliableUdpMessageTypes.inc"
+#undef DEFINE_PUSH_MESSAGE
+#undef DEFINE_MESSAGE
+#undef DEFINE_REQUEST_RESPONSE
+
+// Runtime lookups, for when we only have a MessageLite pointer or a recieved message type. These
+// use tables built from Frpg2ReliableUdpMessageTypes.inc rather than testing each type in turn.
 bool Protobuf_To_ReliableUdpMessageType(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType& Output);
 bool ReliableUdpMessageType_To_Protobuf(Frpg2ReliableUdpMessageType Type, bool IsResponse, std::shared_ptr<google::protobuf::MessageLite>& Output);
 bool ReliableUdpMessageType_Expects_Response(Frpg2ReliableUdpMessageType Type);
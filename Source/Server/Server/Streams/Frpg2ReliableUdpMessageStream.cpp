@@ -28,9 +28,11 @@ Frpg2ReliableUdpMessageStream::Frpg2ReliableUdpMessageStream(std::shared_ptr<Net
 {
 }
 
-bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo)
+bool Frpg2ReliableUdpMessageStream::SendInternal(Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo)
 {
-    Frpg2ReliableUdpMessage SendMessage = Message;
+    std::scoped_lock lock(StreamMutex);
+
+    Frpg2ReliableUdpMessage SendMessage = std::move(Message);
     if (SendMessage.Header.msg_type == Frpg2ReliableUdpMessageType::Push)
     {
         SendMessage.Header.msg_index = 0xFFFFFFFF;
@@ -47,6 +49,13 @@ bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage&
     }
 
     Frpg2ReliableUdpFragment Packet;
+
+    // Disassemble if required, before encoding takes the payload.
+    if constexpr (BuildConfig::DISASSEMBLE_SENT_MESSAGES)
+    {
+        Packet.Disassembly = Disassemble(SendMessage);
+    }
+
     if (!EncodeMessage(SendMessage, Packet))
     {
         WarningS(Connection->GetName().c_str(), "Failed to convert message to packet.");
@@ -54,12 +63,6 @@ bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage&
         return false;
     }
 
-    // Disassemble if required.
-    if constexpr (BuildConfig::DISASSEMBLE_SENT_MESSAGES)
-    {
-        Packet.Disassembly = Disassemble(SendMessage);
-    }
-
     // TODO: Remove when we have a better way to handle this without breaking abstraction.
     if (ResponseTo != nullptr)
     {
@@ -82,27 +85,47 @@ bool Frpg2ReliableUdpMessageStream::SendInternal(const Frpg2ReliableUdpMessage&
     return true;
 }
 
-bool Frpg2ReliableUdpMessageStream::Send(google::protobuf::MessageLite* Message, const Frpg2ReliableUdpMessage* ResponseTo)
+bool Frpg2ReliableUdpMessageStream::Send(google::protobuf::MessageLite* Message, const Frpg2ReliableUdpMessage* ResponseTo, bool Cacheable)
 {
-    Frpg2ReliableUdpMessage ResponseMessage;
-    ResponseMessage.Payload.resize(Message->ByteSize());
-
+    Frpg2ReliableUdpMessageType MessageType = Frpg2ReliableUdpMessageType::Reply;
     if (ResponseTo == nullptr)
     {
-        if (!Protobuf_To_ReliableUdpMessageType(Message, ResponseMessage.Header.msg_type))
+        if (!Protobuf_To_ReliableUdpMessageType(Message, MessageType))
         {
             WarningS(Connection->GetName().c_str(), "Failed to determine message type by protobuf.");
             InErrorState = true;
             return false;
         }
     }
+
+    return SendProtobuf(Message, MessageType, ResponseTo, Cacheable);
+}
+
+bool Frpg2ReliableUdpMessageStream::SendProtobuf(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType MessageType, const Frpg2ReliableUdpMessage* ResponseTo, bool Cacheable)
+{
+    // Serialize directly into a packet buffer, all the headers for the lower layers
+    // get prepended into its headroom so the payload is never copied again. ByteSize
+    // caches the size of every sub-message, so we can serialize with the cached sizes
+    // rather than having SerializeToArray walk the whole message to size it again.
+    int PayloadSize = Message->ByteSize();
+
+    Frpg2ReliableUdpMessage ResponseMessage;
+    ResponseMessage.Payload = PacketBuffer(PayloadSize);
+    ResponseMessage.Cacheable = Cacheable;
+
+    if (ResponseTo == nullptr)
+    {
+        ResponseMessage.Header.msg_type = MessageType;
+    }
     else
     {
         // TODO: Remove when we have a better way to handle this without breaking abstraction.
         ResponseMessage.AckSequenceIndex = ResponseTo->AckSequenceIndex;
     }
 
-    if (!Message->SerializeToArray(ResponseMessage.Payload.data(), (int)ResponseMessage.Payload.size()))
+    uint8_t* PayloadStart = ResponseMessage.Payload.Data();
+    uint8_t* PayloadEnd = Message->SerializeWithCachedSizesToArray(PayloadStart);
+    if (PayloadEnd - PayloadStart != PayloadSize)
     {
         WarningS(Connection->GetName().c_str(), "Failed to serialize protobuf payload.");
         InErrorState = true;
@@ -120,7 +143,7 @@ bool Frpg2ReliableUdpMessageStream::Send(google::protobuf::MessageLite* Message,
 bool Frpg2ReliableUdpMessageStream::SendRawProtobuf(const std::vector<uint8_t>& Data, const Frpg2ReliableUdpMessage* ResponseTo)
 {
     Frpg2ReliableUdpMessage ResponseMessage;
-    ResponseMessage.Payload = Data;
+    ResponseMessage.Payload = PacketBuffer(Data.data(), Data.size());
 
     if (ResponseTo == nullptr)
     {
@@ -140,8 +163,38 @@ bool Frpg2ReliableUdpMessageStream::SendRawProtobuf(const std::vector<uint8_t>&
     return true;
 }
 
+bool Frpg2ReliableUdpMessageStream::Pump()
+{
+    std::scoped_lock lock(StreamMutex);
+
+    return Frpg2ReliableUdpFragmentStream::Pump();
+}
+
+void Frpg2ReliableUdpMessageStream::HandledPacket(uint32_t AckSequence)
+{
+    std::scoped_lock lock(StreamMutex);
+
+    Frpg2ReliableUdpFragmentStream::HandledPacket(AckSequence);
+}
+
+void Frpg2ReliableUdpMessageStream::Disconnect()
+{
+    std::scoped_lock lock(StreamMutex);
+
+    Frpg2ReliableUdpFragmentStream::Disconnect();
+}
+
+Frpg2ReliableUdpPacketStreamStatistics Frpg2ReliableUdpMessageStream::GetStatistics()
+{
+    std::scoped_lock lock(StreamMutex);
+
+    return Frpg2ReliableUdpFragmentStream::GetStatistics();
+}
+
 bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
 {
+    std::scoped_lock lock(StreamMutex);
+
     Frpg2ReliableUdpFragment Packet;
     if (!Frpg2ReliableUdpFragmentStream::Recieve(&Packet))
     {
@@ -196,14 +249,14 @@ bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
         {            
             std::filesystem::path file_path = StringFormat("Debug\\Packets\\No Handler\\0x%04x\\%i.bin", (int)MessageType, DumpMessageIndex++);
             std::filesystem::create_directories(file_path.parent_path());
-            WriteBytesToFile(file_path, Message->Payload);
+            WriteBytesToFile(file_path, Message->Payload.ToVector());
         }
 
         InErrorState = true;
         return false;
     }
 
-    if (!Message->Protobuf->ParseFromArray(Message->Payload.data(), (int)Message->Payload.size()))
+    if (!Message->Protobuf->ParseFromArray(Message->Payload.Data(), (int)Message->Payload.Size()))
     {
         WarningS(Connection->GetName().c_str(), "Failed to deserialize protobuf instance for message: type=0x%08x index=0x%08x", MessageType, Message->Header.msg_index);
 
@@ -211,7 +264,7 @@ bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
         {
             std::filesystem::path file_path = StringFormat("Debug\\Packets\\Failed Deserialize\\0x%04x\\%i.bin", (int)MessageType, DumpMessageIndex++);
             std::filesystem::create_directories(file_path.parent_path());
-            WriteBytesToFile(file_path, Message->Payload);
+            WriteBytesToFile(file_path, Message->Payload.ToVector());
         }
 
         InErrorState = true;
@@ -223,57 +276,54 @@ bool Frpg2ReliableUdpMessageStream::Recieve(Frpg2ReliableUdpMessage* Message)
 
 bool Frpg2ReliableUdpMessageStream::DecodeMessage(const Frpg2ReliableUdpFragment& Packet, Frpg2ReliableUdpMessage& Message)
 {
-    if (Packet.Payload.size() < sizeof(Frpg2ReliableUdpMessageHeader))
+    if (Packet.Payload.Size() < sizeof(Frpg2ReliableUdpMessageHeader))
     {
         WarningS(Connection->GetName().c_str(), "Packet payload is less than the minimum size of a message, failed to deserialize.");
         InErrorState = true;
         return false;
     }
 
-    int ReadOffset = 0;
-    memcpy(&Message.Header, Packet.Payload.data(), sizeof(Frpg2ReliableUdpMessageHeader));
-    ReadOffset += sizeof(Frpg2ReliableUdpMessageHeader);
+    // Message shares the fragments buffer, headers are just stripped off the front.
+    Message.Payload = Packet.Payload;
+
+    memcpy(&Message.Header, Message.Payload.Data(), sizeof(Frpg2ReliableUdpMessageHeader));
+    Message.Payload.Strip(sizeof(Frpg2ReliableUdpMessageHeader));
     Message.Header.SwapEndian();
 
     if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
     {
-        memcpy(&Message.ResponseHeader, Packet.Payload.data() + ReadOffset, sizeof(Frpg2ReliableUdpMessageResponseHeader));
-        ReadOffset += sizeof(Frpg2ReliableUdpMessageResponseHeader);
-    }
-
-    size_t PayloadLength = Packet.Payload.size() - ReadOffset;
+        if (Message.Payload.Size() < sizeof(Frpg2ReliableUdpMessageResponseHeader))
+        {
+            WarningS(Connection->GetName().c_str(), "Packet payload is less than the minimum size of a reply message, failed to deserialize.");
+            InErrorState = true;
+            return false;
+        }
 
-    Message.Payload.resize(PayloadLength);
-    memcpy(Message.Payload.data(), Packet.Payload.data() + ReadOffset, PayloadLength);
+        memcpy(&Message.ResponseHeader, Message.Payload.Data(), sizeof(Frpg2ReliableUdpMessageResponseHeader));
+        Message.Payload.Strip(sizeof(Frpg2ReliableUdpMessageResponseHeader));
+    }
 
     return true;
 }
 
-bool Frpg2ReliableUdpMessageStream::EncodeMessage(const Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet)
+bool Frpg2ReliableUdpMessageStream::EncodeMessage(Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet)
 {
-    Frpg2ReliableUdpMessage ByteSwappedMessage = Message;
-    ByteSwappedMessage.Header.SwapEndian();
-    ByteSwappedMessage.ResponseHeader.SwapEndian();
-
-    size_t PayloadSize = sizeof(Frpg2ReliableUdpMessageHeader) + ByteSwappedMessage.Payload.size();
-    if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
-    {
-        PayloadSize += sizeof(Frpg2ReliableUdpMessageResponseHeader);
-    }
+    Frpg2ReliableUdpMessageHeader ByteSwappedHeader = Message.Header;
+    ByteSwappedHeader.SwapEndian();
 
-    Packet.Payload.resize(PayloadSize);
+    Frpg2ReliableUdpMessageResponseHeader ByteSwappedResponseHeader = Message.ResponseHeader;
+    ByteSwappedResponseHeader.SwapEndian();
 
-    int WriteOffset = 0;
-    memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedMessage.Header, sizeof(Frpg2ReliableUdpMessageHeader));
-    WriteOffset += sizeof(Frpg2ReliableUdpMessageHeader);
+    // Headers are prepended into the payloads headroom, in reverse order.
+    Packet.Payload = std::move(Message.Payload);
+    Packet.Cacheable = Message.Cacheable;
 
     if (Message.Header.msg_type == Frpg2ReliableUdpMessageType::Reply)
     {
-        memcpy(Packet.Payload.data() + WriteOffset, &ByteSwappedMessage.ResponseHeader, sizeof(Frpg2ReliableUdpMessageResponseHeader));
-        WriteOffset += sizeof(Frpg2ReliableUdpMessageResponseHeader);
+        memcpy(Packet.Payload.Prepend(sizeof(Frpg2ReliableUdpMessageResponseHeader)), &ByteSwappedResponseHeader, sizeof(Frpg2ReliableUdpMessageResponseHeader));
     }
 
-    memcpy(Packet.Payload.data() + WriteOffset, ByteSwappedMessage.Payload.data(), ByteSwappedMessage.Payload.size());
+    memcpy(Packet.Payload.Prepend(sizeof(Frpg2ReliableUdpMessageHeader)), &ByteSwappedHeader, sizeof(Frpg2ReliableUdpMessageHeader));
 
     return true;
 }
@@ -304,7 +354,7 @@ std::string Frpg2ReliableUdpMessageStream::Disassemble(const Frpg2ReliableUdpMes
     }
 
     Result += "Message Payload:\n";
-    Result += BytesToString(Message.Payload, "\t");
+    Result += BytesToString(Message.Payload.ToVector(), "\t");
 
     return Result;    
 }
\ No newline at end of file
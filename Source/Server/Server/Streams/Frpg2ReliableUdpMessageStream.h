@@ -15,6 +15,8 @@
 #include "Protobuf/Protobufs.h"
 
 #include <unordered_map>
+#include <mutex>
+#include <type_traits>
 
 class Cipher;
 
@@ -25,7 +27,26 @@ public:
     Frpg2ReliableUdpMessageStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient = false);
 
     // Short hand version of Send for protobufs, takes care of constructing the wrapper message.
-    virtual bool Send(google::protobuf::MessageLite* Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
+    // Cacheable should be set for messages that are sent unchanged to lots of clients, so they 
+    // only need to be compressed once. See Frpg2ReliableUdpPayloadCache.
+    virtual bool Send(google::protobuf::MessageLite* Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr, bool Cacheable = false);
+
+    // Same as above, but when the protobuf class is known at the call site its message type
+    // is resolved at compile time rather than looked up from the protobuf's dynamic type.
+    template <typename ProtobufClass>
+    bool Send(ProtobufClass* Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr, bool Cacheable = false)
+    {
+        static_assert(std::is_base_of_v<google::protobuf::MessageLite, ProtobufClass>, "Only protobufs can be sent as messages.");
+
+        if constexpr (Frpg2ReliableUdpMessageTypeTraits<ProtobufClass>::IsMessage)
+        {
+            return SendProtobuf(Message, Frpg2ReliableUdpMessageTypeTraits<ProtobufClass>::MessageType, ResponseTo, Cacheable);
+        }
+        else
+        {
+            return Send(static_cast<google::protobuf::MessageLite*>(Message), ResponseTo, Cacheable);
+        }
+    }
 
     // If we have a protobuf thats already serialized we can send it via this. Code assumes it should be sent with Push message type.
     virtual bool SendRawProtobuf(const std::vector<uint8_t>& Data, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
@@ -33,6 +54,12 @@ public:
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     virtual bool Recieve(Frpg2ReliableUdpMessage* Message);
 
+    // Overridden so we can take the stream lock, see StreamMutex.
+    virtual bool Pump() override;
+    virtual void HandledPacket(uint32_t AckSequence) override;
+    virtual void Disconnect() override;
+    virtual Frpg2ReliableUdpPacketStreamStatistics GetStatistics() override;
+
     // This is kinda gross, we shouldn't expose this we should wrap it in a nice interface.
     // This returns the ack sequence number of the last sent message. Higher level code
     // can use this to manually wait for responses to specific messages.
@@ -44,11 +71,16 @@ public:
 protected:
 
     // Returns true if send was successful, if false is returned the send queue
-    // is likely saturated or the packet is invalid.
-    virtual bool SendInternal(const Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
+    // is likely saturated or the packet is invalid. The messages payload is handed
+    // down to the lower layers, so it shouldn't be used afterwards.
+    virtual bool SendInternal(Frpg2ReliableUdpMessage& Message, const Frpg2ReliableUdpMessage* ResponseTo = nullptr);
+
+    // Serializes and sends a protobuf with an already resolved message type. The type is
+    // ignored if ResponseTo is set, responses are always sent as replies.
+    bool SendProtobuf(google::protobuf::MessageLite* Message, Frpg2ReliableUdpMessageType MessageType, const Frpg2ReliableUdpMessage* ResponseTo, bool Cacheable);
 
     bool DecodeMessage(const Frpg2ReliableUdpFragment& Packet, Frpg2ReliableUdpMessage& Message);
-    bool EncodeMessage(const Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet);
+    bool EncodeMessage(Frpg2ReliableUdpMessage& Message, Frpg2ReliableUdpFragment& Packet);
 
     virtual void Reset() override;
 
@@ -68,4 +100,9 @@ private:
 
     static inline size_t DumpMessageIndex = 0;
 
+    // When the game service is sharded across threads, clients can have messages
+    // pushed to them from other threads (eg. break-in requests) while their own 
+    // thread is pumping the stream, so all public entry points take this lock.
+    std::recursive_mutex StreamMutex;
+
 };
\ No newline at end of file
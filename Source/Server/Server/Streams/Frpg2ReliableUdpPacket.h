@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Core/Utils/Endian.h"
+#include "Core/Utils/PacketBuffer.h"
 
 #include <vector>
 #include <string>
@@ -171,14 +172,39 @@ public:
     Frpg2ReliableUdpPacketHeader Header;
 
     // Length is equal to the rest of the payload minus the header.
-    std::vector<uint8_t> Payload;
+    PacketBuffer Payload;
 
     std::string Disassembly;
 
+    // Empties the packet for reuse by the streams queues, keeping the storage of its payload 
+    // (if nothing else references it) and disassembly.
+    void Reset()
+    {
+        Header = Frpg2ReliableUdpPacketHeader();
+        Payload.Clear();
+        Encoded.Clear();
+        Disassembly.clear();
+        SendTime = 0.0;
+        RecieveTime = 0.0;
+        Retransmitted = false;
+    }
+
 private:
     friend class Frpg2ReliableUdpPacketStream;
 
     // Use for internal bookkeeping when sending/recieving the packet.
-    double SendTime;
+    double SendTime = 0.0;
+
+    // Time the datagram carrying this packet arrived, acks it carries are timed from 
+    // this rather than from when we got round to processing them.
+    double RecieveTime = 0.0;
+
+    // Encrypted datagram from when the packet was first sent. Retransmits resend this rather 
+    // than encoding and encrypting the packet again, the payload has been taken by then.
+    PacketBuffer Encoded;
+
+    // Set once the packet has been retransmitted, its ack can no longer be 
+    // used to measure the round trip time (Karn's algorithm).
+    bool Retransmitted = false;
 
 };
\ No newline at end of file
@@ -18,16 +18,27 @@
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/File.h"
 #include "Core/Utils/Strings.h"
+#include "Core/Utils/TimerWheel.h"
 
 #include "Core/Crypto/RSAKeyPair.h"
 #include "Core/Crypto/RSACipher.h"
 
 #include <thread>
 #include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <limits>
 
 Frpg2ReliableUdpPacketStream::Frpg2ReliableUdpPacketStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient)
     : Frpg2UdpPacketStream(Connection, CwcKey, AuthToken, AsClient)
 {
+    ReorderBuffer.resize(REORDER_BUFFER_SIZE);
+    ReorderBufferOccupied.resize(REORDER_BUFFER_SIZE, false);
+
+    RecieveQueue = RingBuffer<Frpg2ReliableUdpPacket>(REORDER_BUFFER_SIZE);
+    SendQueue = RingBuffer<Frpg2ReliableUdpPacket>(SEND_QUEUE_SIZE);
+    RetransmitBuffer = RingBuffer<Frpg2ReliableUdpPacket>((size_t)MAX_CONGESTION_WINDOW);
+
     Reset();
 }
 
@@ -35,6 +46,7 @@ void Frpg2ReliableUdpPacketStream::Disconnect()
 {
     if (State == Frpg2ReliableUdpStreamState::Established)
     {
+        FlushPendingAck(true);
         Send_FIN();
     }
 }
@@ -48,7 +60,7 @@ void Frpg2ReliableUdpPacketStream::Connect(const std::string& ClientSteamId)
     Send_SYN();
 }
 
-bool Frpg2ReliableUdpPacketStream::Send(const Frpg2ReliableUdpPacket& Input)
+bool Frpg2ReliableUdpPacketStream::Send(Frpg2ReliableUdpPacket& Input)
 {
     // Swallow any packets being sent while we are closing.
     if (State == Frpg2ReliableUdpStreamState::Closing)
@@ -58,7 +70,14 @@ bool Frpg2ReliableUdpPacketStream::Send(const Frpg2ReliableUdpPacket& Input)
 
     if (IsOpcodeSequenced(Input.Header.opcode) || Input.Header.opcode == Frpg2ReliableUdpOpCode::Unset)
     {
-        Frpg2ReliableUdpPacket SentPacket = Input;
+        if (!SendQueue.PushBack(std::move(Input)))
+        {
+            WarningS(Connection->GetName().c_str(), "Send queue is full, unable to send packet.");
+            return false;
+        }
+
+        // Fill in the queued copy directly.
+        Frpg2ReliableUdpPacket& SentPacket = SendQueue.Back();
         SentPacket.SendTime = GetSeconds();
 
         // Opcode note set, we fill in the opcode and ack counters then
@@ -84,8 +103,6 @@ bool Frpg2ReliableUdpPacketStream::Send(const Frpg2ReliableUdpPacket& Input)
         }
 
         SequenceIndex = (SequenceIndex + 1) % MAX_ACK_VALUE;
-        
-        SendQueue.push_back(SentPacket);
     }
     else
     {
@@ -97,10 +114,10 @@ bool Frpg2ReliableUdpPacketStream::Send(const Frpg2ReliableUdpPacket& Input)
 
 bool Frpg2ReliableUdpPacketStream::Recieve(Frpg2ReliableUdpPacket* Output)
 {
-    if (RecieveQueue.size() > 0)
+    if (!RecieveQueue.Empty())
     {
-        *Output = RecieveQueue[0];
-        RecieveQueue.erase(RecieveQueue.begin());
+        *Output = std::move(RecieveQueue.Front());
+        RecieveQueue.PopFront();
 
         return true;
     }
@@ -110,34 +127,41 @@ bool Frpg2ReliableUdpPacketStream::Recieve(Frpg2ReliableUdpPacket* Output)
 
 bool Frpg2ReliableUdpPacketStream::DecodeReliablePacket(const Frpg2UdpPacket& Input, Frpg2ReliableUdpPacket& Output)
 {
-    if (Input.Payload.size() < sizeof(Frpg2ReliableUdpPacketHeader))
+    if (Input.Payload.Size() < sizeof(Frpg2ReliableUdpPacketHeader))
     {
         WarningS(Connection->GetName().c_str(), "Packet payload is less than the minimum size of a message, failed to deserialize.");
         InErrorState = true;
         return false;
     }
 
-    int HeaderOffset = 0;
-    int PayloadOffset = sizeof(Frpg2ReliableUdpPacketHeader);
-    int PayloadSize = (int)Input.Payload.size() - sizeof(Frpg2ReliableUdpPacketHeader);    
-    Ensure(Input.Payload[HeaderOffset] == 0xF5 && Input.Payload[HeaderOffset + 1] == 0x02);
-    Output.Payload.resize(PayloadSize);
+    Ensure(Input.Payload[0] == 0xF5 && Input.Payload[1] == 0x02);
 
-    memcpy(&Output.Header, Input.Payload.data() + HeaderOffset, sizeof(Frpg2ReliableUdpPacketHeader));
-    memcpy(Output.Payload.data(), Input.Payload.data() + PayloadOffset, PayloadSize);
+    memcpy(&Output.Header, Input.Payload.Data(), sizeof(Frpg2ReliableUdpPacketHeader));
+    Output.RecieveTime = Input.RecieveTime;
+
+    // Payload shares the packets buffer, we just strip the header off the front.
+    Output.Payload = Input.Payload;
+    Output.Payload.Strip(sizeof(Frpg2ReliableUdpPacketHeader));
 
     //Output.Header.SwapEndian();
 
     return true;
 }
 
-bool Frpg2ReliableUdpPacketStream::EncodeReliablePacket(const Frpg2ReliableUdpPacket& Input, Frpg2UdpPacket& Output)
+bool Frpg2ReliableUdpPacketStream::EncodeReliablePacket(Frpg2ReliableUdpPacket& Input, Frpg2UdpPacket& Output)
 {
-    Frpg2ReliableUdpPacket ByteSwappedMessage = Input;
-    //ByteSwappedMessage.Header.SwapEndian();
+    Frpg2ReliableUdpPacketHeader ByteSwappedHeader = Input.Header;
+    //ByteSwappedHeader.SwapEndian();
 
+    // Header is prepended into the payloads headroom rather than copying the payload. The 
+    // payload is taken from the input, nothing else should be referencing it as anyone sharing
+    // the headroom would see it overwritten (and the payload gets encrypted in place after this).
     Output.HasConnectionPrefix = false;
-    Output.Payload.resize(0);
+    Output.Payload = std::move(Input.Payload);
+
+    Ensure(!Output.Payload.IsShared());
+
+    memcpy(Output.Payload.Prepend(sizeof(Frpg2ReliableUdpPacketHeader)), &ByteSwappedHeader, sizeof(Frpg2ReliableUdpPacketHeader));
 
     // Before the SYN we have to append the steam id data.
     if (Input.Header.opcode == Frpg2ReliableUdpOpCode::SYN)
@@ -146,19 +170,11 @@ bool Frpg2ReliableUdpPacketStream::EncodeReliablePacket(const Frpg2ReliableUdpPa
         strcpy(InitialData.steam_id, SteamId.c_str());
         strcpy(InitialData.steam_id_copy, SteamId.c_str());
 
-        Output.Payload.resize(sizeof(Frpg2ReliableUdpInitialData));
-        memcpy(Output.Payload.data(), &InitialData, sizeof(Frpg2ReliableUdpInitialData));
+        memcpy(Output.Payload.Prepend(sizeof(Frpg2ReliableUdpInitialData)), &InitialData, sizeof(Frpg2ReliableUdpInitialData));
 
         Output.HasConnectionPrefix = true;
     }
 
-    size_t Offset = Output.Payload.size();
-
-    Output.Payload.resize(Offset + sizeof(Frpg2ReliableUdpPacketHeader) + Input.Payload.size());
-
-    memcpy(Output.Payload.data() + Offset, &ByteSwappedMessage.Header, sizeof(Frpg2ReliableUdpPacketHeader));
-    memcpy(Output.Payload.data() + Offset + sizeof(Frpg2ReliableUdpPacketHeader), Input.Payload.data(), Input.Payload.size());
-
     return true;
 }
 
@@ -175,15 +191,12 @@ void Frpg2ReliableUdpPacketStream::HandleIncoming()
 
         // This is the initial packet that contains the connection data before it.
         // Strip this data off, we don't really care about it, just some steam id's.
-        if (Packet.Payload.size() > sizeof(Frpg2ReliableUdpInitialData) && Packet.Payload[0] != 0xF5 && Packet.Payload[0] != 0x25)
+        if (Packet.Payload.Size() > sizeof(Frpg2ReliableUdpInitialData) && Packet.Payload[0] != 0xF5 && Packet.Payload[0] != 0x25)
         {
             Frpg2ReliableUdpInitialData InitialData;
-            memcpy(&InitialData, Packet.Payload.data(), sizeof(Frpg2ReliableUdpInitialData));
+            memcpy(&InitialData, Packet.Payload.Data(), sizeof(Frpg2ReliableUdpInitialData));
 
-            std::vector<uint8_t> StrippedPayload;
-            StrippedPayload.resize(Packet.Payload.size() - sizeof(Frpg2ReliableUdpInitialData));
-            memcpy(StrippedPayload.data(), Packet.Payload.data() + sizeof(Frpg2ReliableUdpInitialData), StrippedPayload.size());
-            Packet.Payload = StrippedPayload;
+            Packet.Payload.Strip(sizeof(Frpg2ReliableUdpInitialData));
         }
 
         Frpg2ReliableUdpPacket ReliablePacket;
@@ -209,42 +222,94 @@ void Frpg2ReliableUdpPacketStream::HandleIncoming()
         HandleIncomingPacket(ReliablePacket);
     }
 
-    // Process as many packets as we can off the pending queue.
-    while (PendingRecieveQueue.size() > 0)
+    // Process as many packets as we can off the reorder buffer.
+    while (!RecieveQueue.Full())
     {
-        Frpg2ReliableUdpPacket& Next = PendingRecieveQueue[0];
-        
-        uint32_t Local, Remote;
-        Next.Header.GetAckCounters(Local, Remote);
-
-        if (Local == GetNextRemoteSequenceIndex())
-        {
-            ProcessPacket(Next);
-      
-            PendingRecieveQueue.erase(PendingRecieveQueue.begin());
-
-            RemoteSequenceIndex = (RemoteSequenceIndex + 1) % MAX_ACK_VALUE;
-        }
-        else
+        uint32_t NextSequenceIndex = GetNextRemoteSequenceIndex();
+        size_t Slot = NextSequenceIndex % REORDER_BUFFER_SIZE;
+        if (!ReorderBufferOccupied[Slot])
         {
             break;
         }
+
+        ProcessPacket(ReorderBuffer[Slot]);
+        ReorderBuffer[Slot].Reset();
+        ReorderBufferOccupied[Slot] = false;
+
+        RemoteSequenceIndex = NextSequenceIndex;
     }
 }
 
-int Frpg2ReliableUdpPacketStream::GetPacketIndexByLocalSequence(const std::vector<Frpg2ReliableUdpPacket>& Queue, uint32_t SequenceIndex)
+int Frpg2ReliableUdpPacketStream::GetSequenceDistance(uint32_t From, uint32_t To)
 {
-    for (size_t i = 0; i < Queue.size(); i++)
+    int Distance = (int)((To + MAX_ACK_VALUE - From) % MAX_ACK_VALUE);
+    if (Distance >= (int)(MAX_ACK_VALUE / 2))
     {
-        uint32_t Local, Remote;
-        Queue[i].Header.GetAckCounters(Local, Remote);
+        Distance -= (int)MAX_ACK_VALUE;
+    }
+    return Distance;
+}
+
+bool Frpg2ReliableUdpPacketStream::UpdateSequenceIndexAcked(uint32_t Ack, double ArrivalTime)
+{
+    // Ignore anything that is behind what has already been acked, or acks packets
+    // we haven't sent yet.
+    uint32_t LastSentSequenceIndex = (SequenceIndex + MAX_ACK_VALUE - 1) % MAX_ACK_VALUE;
 
-        if (Local == SequenceIndex)
+    int Distance = GetSequenceDistance(SequenceIndexAcked, Ack);
+    if (Distance > 0 && Distance <= GetSequenceDistance(SequenceIndexAcked, LastSentSequenceIndex))
+    {
+        SequenceIndexAcked = Ack;
+        DuplicateAckCount = 0;
+
+        ReleaseAckedPackets(ArrivalTime);
+        return true;
+    }
+
+    return false;
+}
+
+void Frpg2ReliableUdpPacketStream::ReleaseAckedPackets(double ArrivalTime)
+{
+    // The buffer is in sequence order so the acked packets are always at the front.
+    size_t AckedPackets = 0;
+    bool AckedRetransmittedPacket = false;
+    double LastAckedSendTime = 0.0;
+    while (!RetransmitBuffer.Empty())
+    {
+        Frpg2ReliableUdpPacket& Packet = RetransmitBuffer.Front();
+
+        uint32_t InLocalAck, InRemoteAck;
+        Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
+
+        if (GetSequenceDistance(SequenceIndexAcked, InLocalAck) > 0)
         {
-            return (int)i;
+            break;
         }
+
+        AckedPackets++;
+        AckedRetransmittedPacket = AckedRetransmittedPacket || Packet.Retransmitted;
+        LastAckedSendTime = Packet.SendTime;
+
+        RetransmitBuffer.PopFront();
+    }
+
+    if (AckedPackets == 0)
+    {
+        return;
     }
-    return -1;
+
+    // Use the most recently sent packet that was acked to measure the round trip time. If 
+    // any were retransmitted we don't know which transmission was acked so skip the sample.
+    if (!AckedRetransmittedPacket)
+    {
+        UpdateRoundTripTime(ArrivalTime - LastAckedSendTime);
+    }
+
+    GrowCongestionWindow(AckedPackets);
+
+    // The oldest unacked packet has changed, so has when it needs retransmitting.
+    UpdateRetransmitTimer();
 }
 
 bool Frpg2ReliableUdpPacketStream::IsOpcodeSequenced(Frpg2ReliableUdpOpCode Opcode)
@@ -282,35 +347,45 @@ void Frpg2ReliableUdpPacketStream::HandleIncomingPacket(const Frpg2ReliableUdpPa
             return;
         }
 
-        bool IsInCorrectSequence = false;
+        // Anything at or behind the current head is a duplicate, anything ahead of it is held
+        // in the reorder buffer until we have everything before it.
+        int Distance = GetSequenceDistance(RemoteSequenceIndex, LocalAck);
+        size_t Slot = LocalAck % REORDER_BUFFER_SIZE;
 
-        // TODO: Fix this so we can queue up out of order packets and handle them when recieved. We had this before but causes issues
-        //       when ack values overflow.
-        if (LocalAck != GetNextRemoteSequenceIndex())
+        bool IsDuplicate = false;
+        if (Distance <= 0)
         {
-            VerboseS(Connection->GetName().c_str(), "Ignoring incoming packet, out of sequence (incoming=%i head=%i).", LocalAck, RemoteSequenceIndex);
-            IsInCorrectSequence = true;
+            VerboseS(Connection->GetName().c_str(), "Ignoring incoming packet, already processed (incoming=%i head=%i).", LocalAck, RemoteSequenceIndex);
+            IsDuplicate = true;
         }
-
-        if (GetPacketIndexByLocalSequence(PendingRecieveQueue, LocalAck) >= 0)
+        else if (Distance >= (int)REORDER_BUFFER_SIZE)
+        {
+            VerboseS(Connection->GetName().c_str(), "Ignoring incoming packet, too far ahead of sequence to buffer (incoming=%i head=%i).", LocalAck, RemoteSequenceIndex);
+            return;
+        }
+        else if (ReorderBufferOccupied[Slot])
         {
             VerboseS(Connection->GetName().c_str(), "Ignoring incoming packet, duplicate that we already have.");
-            IsInCorrectSequence = true;
+            IsDuplicate = true;
+        }
+        else
+        {
+            if (Distance > 1)
+            {
+                VerboseS(Connection->GetName().c_str(), "Buffering incoming packet, out of sequence (incoming=%i head=%i).", LocalAck, RemoteSequenceIndex);
+            }
+
+            ReorderBuffer[Slot] = Packet;
+            ReorderBufferOccupied[Slot] = true;
         }
 
-        if (IsInCorrectSequence && (GetSeconds() - LastAckSendTime) > MIN_TIME_BETWEEN_RESEND_ACK)
+        // Send an ACK if we get a duplicate or something out of order, its possible that the remote is
+        // retransmitting packets as a previously sent ACK has dropped.
+        if ((IsDuplicate || Distance > 1) && (GetSeconds() - LastAckSendTime) > MIN_TIME_BETWEEN_RESEND_ACK)
         {   
-            // Send an ACK, its possible that the remote is retransmitting packets as
-            // a previously sent ACK has dropped.
             Verbose("Sending ack as not sent in a while.");
 
-            Send_ACK(RemoteSequenceIndexAcked);
-
-            return;
-        }
-        else if (!IsInCorrectSequence)
-        {
-            PendingRecieveQueue.push_back(Packet);
+            Queue_ACK(RemoteSequenceIndexAcked);
         }
     }
     else
@@ -422,15 +497,7 @@ void Frpg2ReliableUdpPacketStream::Handle_HBT(const Frpg2ReliableUdpPacket& Pack
     uint32_t InLocalAck, InRemoteAck;
     Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
 
-    // TODO: Handle overflow - This is super crude,  do it in a better way.
-    if (SequenceIndexAcked > MAX_ACK_VALUE_TOP_QUART && InRemoteAck < MAX_ACK_VALUE_BOTTOM_QUART)
-    {
-        SequenceIndexAcked = InRemoteAck;
-    }
-    else
-    {
-        SequenceIndexAcked = std::max(SequenceIndexAcked, InRemoteAck);
-    }
+    UpdateSequenceIndexAcked(InRemoteAck, Packet.RecieveTime);
 
     Send_HBT();
 }
@@ -468,18 +535,19 @@ void Frpg2ReliableUdpPacketStream::Handle_ACK(const Frpg2ReliableUdpPacket& Pack
     uint32_t InLocalAck, InRemoteAck;
     Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
 
-    uint32_t SequenceIndexAckedOriginal = SequenceIndexAcked;
-     
-    // TODO: Handle overflow - This is super crude,  do it in a better way.
-    if (SequenceIndexAcked > MAX_ACK_VALUE_TOP_QUART && InRemoteAck < MAX_ACK_VALUE_BOTTOM_QUART)
+    // Only pure ACKs count as duplicates, DAT_ACK and HBT repeat the same ack index 
+    // as a matter of course while nothing is being lost.
+    if (!UpdateSequenceIndexAcked(InRemoteAck, Packet.RecieveTime) && InRemoteAck == SequenceIndexAcked && RetransmitBuffer.Size() > 1)
     {
-        SequenceIndexAcked = InRemoteAck;
-    }
-    else
-    {
-        SequenceIndexAcked = std::max(SequenceIndexAcked, InRemoteAck);
+        // Only retransmit once per loss, the count is reset when the ack moves on.
+        DuplicateAckCount++;
+        if (DuplicateAckCount == FAST_RETRANSMIT_DUPLICATE_ACKS)
+        {
+            FastRetransmit();
+        }
     }
 }
+
 void Frpg2ReliableUdpPacketStream::Handle_RACK(const Frpg2ReliableUdpPacket& Packet)
 {
     // I'm like 95% sure that RACK is "Reject ACK", its telling us the ACK recieved was invalid I think?
@@ -495,9 +563,9 @@ void Frpg2ReliableUdpPacketStream::Handle_DAT(const Frpg2ReliableUdpPacket& Pack
 
     ExpectedDatAckResponses.insert(InLocalAck);
 
-    RecieveQueue.push_back(Packet);
+    RecieveQueue.PushBack(Packet);
 
-    Send_ACK(InLocalAck);
+    Queue_ACK(InLocalAck);
 }
 
 void Frpg2ReliableUdpPacketStream::Handle_DAT_ACK(const Frpg2ReliableUdpPacket& Packet)
@@ -505,22 +573,12 @@ void Frpg2ReliableUdpPacketStream::Handle_DAT_ACK(const Frpg2ReliableUdpPacket&
     uint32_t InLocalAck, InRemoteAck;
     Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
 
-    uint32_t SequenceIndexAckedOriginal = SequenceIndexAcked;
-
-    // TODO: Handle overflow - This is super crude,  do it in a better way.
-    if (SequenceIndexAcked > MAX_ACK_VALUE_TOP_QUART && InRemoteAck < MAX_ACK_VALUE_BOTTOM_QUART)
-    {
-        SequenceIndexAcked = InRemoteAck;
-    }
-    else
-    {
-        SequenceIndexAcked = std::max(SequenceIndexAcked, InRemoteAck);
-    }
+    UpdateSequenceIndexAcked(InRemoteAck, Packet.RecieveTime);
     
     // Send an ACK for this DAT_ACK.
-    Send_ACK(InLocalAck);
+    Queue_ACK(InLocalAck);
 
-    RecieveQueue.push_back(Packet);
+    RecieveQueue.PushBack(Packet);
 }
 
 void Frpg2ReliableUdpPacketStream::Send_SYN()
@@ -531,8 +589,7 @@ void Frpg2ReliableUdpPacketStream::Send_SYN()
 
     Frpg2ReliableUdpPacketOpCodePayload_SYN SynPayload;
 
-    SynRequest.Payload.resize(sizeof(SynPayload));
-    memcpy(SynRequest.Payload.data(), &SynPayload, sizeof(SynPayload));
+    SynRequest.Payload = PacketBuffer((const uint8_t*)&SynPayload, sizeof(SynPayload));
 
     Send(SynRequest);
 }
@@ -547,8 +604,7 @@ void Frpg2ReliableUdpPacketStream::Send_SYN_ACK(uint32_t RemoteIndex)
     // should figure out what they are regardless.
     Frpg2ReliableUdpPacketOpCodePayload_SYN_ACK SynPayload;
 
-    SynAckResponse.Payload.resize(sizeof(SynPayload));
-    memcpy(SynAckResponse.Payload.data(), &SynPayload, sizeof(SynPayload));
+    SynAckResponse.Payload = PacketBuffer((const uint8_t*)&SynPayload, sizeof(SynPayload));
 
     Send(SynAckResponse);
 
@@ -572,6 +628,47 @@ void Frpg2ReliableUdpPacketStream::Send_ACK(uint32_t RemoteIndex)
     LastAckSendTime = GetSeconds();
 }
 
+void Frpg2ReliableUdpPacketStream::Queue_ACK(uint32_t RemoteIndex)
+{
+    if (AckDelay <= 0.0)
+    {
+        Send_ACK(RemoteIndex);
+        return;
+    }
+
+    // Already have one waiting, acks are cumulative so just send the later of the two.
+    if (AckPending)
+    {
+        if (GetSequenceDistance(PendingAckIndex, RemoteIndex) > 0)
+        {
+            PendingAckIndex = RemoteIndex;
+        }
+        AcksCoalescedCount++;
+        return;
+    }
+
+    AckPending = true;
+    PendingAckIndex = RemoteIndex;
+
+    // Pump flushes it once the deadline passes, the deadline is included in 
+    // GetNextPollTime so we get pumped in time.
+    PendingAckDeadline = GetSeconds() + AckDelay;
+}
+
+void Frpg2ReliableUdpPacketStream::FlushPendingAck(bool Force)
+{
+    if (!AckPending)
+    {
+        return;
+    }
+
+    if (Force || GetSeconds() >= PendingAckDeadline)
+    {
+        AckPending = false;
+        Send_ACK(PendingAckIndex);
+    }
+}
+
 void Frpg2ReliableUdpPacketStream::Send_DAT_ACK(uint32_t LocalIndex, uint32_t RemoteIndex)
 {
     Frpg2ReliableUdpPacket AckResponse;
@@ -614,27 +711,49 @@ void Frpg2ReliableUdpPacketStream::Send_HBT()
     Send(HbtResponse);
 }
 
-bool Frpg2ReliableUdpPacketStream::SendRaw(const Frpg2ReliableUdpPacket& Input)
+bool Frpg2ReliableUdpPacketStream::SendRaw(Frpg2ReliableUdpPacket& Input)
 {
     uint32_t LocalAck, RemoteAck;
     Input.Header.GetAckCounters(LocalAck, RemoteAck);
 
     Ensure(Input.Header.opcode != Frpg2ReliableUdpOpCode::Unset);
 
+    // Anything that acks at least as far as the pending ack makes sending it unnecessary.
+    if (Input.Header.opcode == Frpg2ReliableUdpOpCode::ACK)
+    {
+        AcksSentCount++;
+    }
+    if (AckPending && GetSequenceDistance(PendingAckIndex, RemoteAck) >= 0)
+    {
+        if (Input.Header.opcode == Frpg2ReliableUdpOpCode::DAT_ACK ||
+            Input.Header.opcode == Frpg2ReliableUdpOpCode::HBT)
+        {
+            AckPending = false;
+            AcksPiggybackedCount++;
+        }
+        else if (Input.Header.opcode == Frpg2ReliableUdpOpCode::ACK)
+        {
+            AckPending = false;
+            AcksCoalescedCount++;
+        }
+    }
+
+    // Retransmits resend the encrypted datagram kept from the first send rather than encoding 
+    // and encrypting the packet again. The cipher uses a random IV per datagram rather than a
+    // counter, so the remote end has no problem with recieving the same one twice.
+    if (!Input.Encoded.Empty())
+    {
+        return SendBytes(Input.Encoded);
+    }
+
     if constexpr (BuildConfig::EMIT_RELIABLE_UDP_PACKET_STREAM)
     {
         EmitDebugInfo(false, Input);
     }
 
     Frpg2UdpPacket Packet;
-    if (!EncodeReliablePacket(Input, Packet))
-    {
-        WarningS(Connection->GetName().c_str(), "Failed to convert message to packet payload.");
-        InErrorState = true;
-        return false;
-    }
 
-    // Disassemble if required.
+    // Disassemble if required, before encoding takes the payload.
     if constexpr (BuildConfig::DISASSEMBLE_SENT_MESSAGES)
     {
         Packet.Disassembly = Input.Disassembly;
@@ -643,6 +762,13 @@ bool Frpg2ReliableUdpPacketStream::SendRaw(const Frpg2ReliableUdpPacket& Input)
         Log("\n>> SENT\n%s", Packet.Disassembly.c_str());
     }
 
+    if (!EncodeReliablePacket(Input, Packet))
+    {
+        WarningS(Connection->GetName().c_str(), "Failed to convert message to packet payload.");
+        InErrorState = true;
+        return false;
+    }
+
     if (!Frpg2UdpPacketStream::Send(Packet))
     {
         WarningS(Connection->GetName().c_str(), "Failed to send.");
@@ -650,85 +776,186 @@ bool Frpg2ReliableUdpPacketStream::SendRaw(const Frpg2ReliableUdpPacket& Input)
         return false;
     }
 
+    // Sequenced packets are held onto until they are acked, keep the datagram for retransmits.
+    if (IsOpcodeSequenced(Input.Header.opcode))
+    {
+        Input.Encoded = std::move(Packet.Payload);
+    }
+
     return true;
 }
 
 void Frpg2ReliableUdpPacketStream::Reset()
 {
     SequenceIndex = START_SEQUENCE_INDEX;
-    SequenceIndexAcked = 0;
+    SequenceIndexAcked = START_SEQUENCE_INDEX - 1;
     RemoteSequenceIndex = 0;
     RemoteSequenceIndexAcked = 0;
 
-    PendingRecieveQueue.clear();
-    RecieveQueue.clear();    
-    SendQueue.clear();
-    RetransmitBuffer.clear();
+    std::fill(ReorderBufferOccupied.begin(), ReorderBufferOccupied.end(), false);
+    RecieveQueue.Clear();
+    SendQueue.Clear();
+    RetransmitBuffer.Clear();
+
+    SmoothedRtt = 0.0;
+    RttVariance = 0.0;
+    HasRttSample = false;
+    RetransmitTimeout = INITIAL_RETRANSMIT_TIMEOUT;
+
+    CongestionWindow = INITIAL_CONGESTION_WINDOW;
+    SlowStartThreshold = MAX_CONGESTION_WINDOW;
+
+    AckPending = false;
+    DuplicateAckCount = 0;
+
+    IsRetransmitting = false;
+    RetransmittingIndex = 0;
+    RetransmitAttempts = 0;
+    RetransmissionTimer = 0.0;
+
+    if (Timers != nullptr)
+    {
+        CancelRetransmitTimer();
+    }
 }
 
-void Frpg2ReliableUdpPacketStream::HandleOutgoing()
+Frpg2ReliableUdpPacketStreamStatistics Frpg2ReliableUdpPacketStream::GetStatistics()
 {
-    // Trim off any retransmit packets that are not long relevant.
-    for (auto iter = RetransmitBuffer.begin(); iter != RetransmitBuffer.end(); /* empty */)
+    Frpg2ReliableUdpPacketStreamStatistics Result;
+    Result.SmoothedRtt = SmoothedRtt;
+    Result.RttVariance = RttVariance;
+    Result.RetransmitTimeout = RetransmitTimeout;
+    Result.Retransmits = RetransmitCount;
+    Result.FastRetransmits = FastRetransmitCount;
+    Result.AcksSent = AcksSentCount;
+    Result.AcksCoalesced = AcksCoalescedCount;
+    Result.AcksPiggybacked = AcksPiggybackedCount;
+    Result.CongestionWindow = CongestionWindow;
+    return Result;
+}
+
+void Frpg2ReliableUdpPacketStream::UpdateRoundTripTime(double Sample)
+{
+    if (!HasRttSample)
+    {
+        SmoothedRtt = Sample;
+        RttVariance = Sample / 2.0;
+        HasRttSample = true;
+    }
+    else
     {
-        Frpg2ReliableUdpPacket& Packet = *iter;
+        RttVariance = (1.0 - RTT_BETA) * RttVariance + RTT_BETA * std::abs(SmoothedRtt - Sample);
+        SmoothedRtt = (1.0 - RTT_ALPHA) * SmoothedRtt + RTT_ALPHA * Sample;
+    }
 
-        uint32_t InLocalAck, InRemoteAck;
-        Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
+    // A new sample also undoes any backoff.
+    RetransmitTimeout = SmoothedRtt + 4.0 * RttVariance;
+    if (RetransmitTimeout < MIN_RETRANSMIT_TIMEOUT)
+    {
+        RetransmitTimeout = MIN_RETRANSMIT_TIMEOUT;
+    }
+    else if (RetransmitTimeout > MAX_RETRANSMIT_TIMEOUT)
+    {
+        RetransmitTimeout = MAX_RETRANSMIT_TIMEOUT;
+    }
 
-        // TODO: Handle overflow - This is super crude,  do it in a better way.
-        if (InLocalAck > MAX_ACK_VALUE_TOP_QUART && SequenceIndexAcked < MAX_ACK_VALUE_BOTTOM_QUART ||
-            InLocalAck <= SequenceIndexAcked)
-        {
-            iter = RetransmitBuffer.erase(iter);
-        }
-        else
-        {
-            iter++;
-        }
+    UpdateRetransmitTimer();
+}
+
+void Frpg2ReliableUdpPacketStream::GrowCongestionWindow(size_t AckedPackets)
+{
+    if (CongestionWindow < SlowStartThreshold)
+    {
+        CongestionWindow += AckedPackets;
+    }
+    else
+    {
+        CongestionWindow += AckedPackets / CongestionWindow;
     }
 
+    if (CongestionWindow > MAX_CONGESTION_WINDOW)
+    {
+        CongestionWindow = MAX_CONGESTION_WINDOW;
+    }
+}
+
+void Frpg2ReliableUdpPacketStream::ShrinkCongestionWindow()
+{
+    CongestionWindow /= 2.0;
+    if (CongestionWindow < MIN_CONGESTION_WINDOW)
+    {
+        CongestionWindow = MIN_CONGESTION_WINDOW;
+    }
+
+    SlowStartThreshold = CongestionWindow;
+}
+
+void Frpg2ReliableUdpPacketStream::BackoffRetransmitTimeout()
+{
+    RetransmitTimeout *= 2.0;
+    if (RetransmitTimeout > MAX_RETRANSMIT_TIMEOUT)
+    {
+        RetransmitTimeout = MAX_RETRANSMIT_TIMEOUT;
+    }
+
+    UpdateRetransmitTimer();
+}
+
+void Frpg2ReliableUdpPacketStream::HandleOutgoing()
+{
     // If we have not had ack of packets in the retransmit queue for long enough, retransmit 
-    // the first one and hope it gets acked soon.
+    // the first one and hope it gets acked soon. The buffer is in send order so only the 
+    // oldest packet needs checking, and when we have a timer wheel only when its timer fires.
     double CurrentTime = GetSeconds();
+
+    // A timer is gone once it has fired, UpdateRetransmitTimer below rearms it if its still needed.
+    bool RetransmitTimerHasFired = *RetransmitTimerFired;
+    if (RetransmitTimerHasFired)
+    {
+        *RetransmitTimerFired = false;
+        RetransmitTimerHandle = TimerWheel::InvalidHandle;
+    }
+
     if (!IsRetransmitting)
     {
-        for (auto iter = RetransmitBuffer.begin(); iter != RetransmitBuffer.end(); iter++)
+        bool CheckRetransmit = (Timers == nullptr || RetransmitTimerHasFired);
+        if (CheckRetransmit && !RetransmitBuffer.Empty())
         {
-            Frpg2ReliableUdpPacket& Packet = *iter;
+            Frpg2ReliableUdpPacket& Packet = RetransmitBuffer.Front();
 
             uint32_t InLocalAck, InRemoteAck;
             Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
 
-            double ElapsedTime = (CurrentTime - Packet.SendTime);
-            if (ElapsedTime > RETRANSMIT_INTERVAL)
+            double RetransmitTime = Packet.SendTime + RetransmitTimeout;
+            if (CurrentTime > RetransmitTime)
             {
-                VerboseS(Connection->GetName().c_str(), "Starting retransmit as we have unacknowledged packets (packet %i).", InLocalAck);
+                VerboseS(Connection->GetName().c_str(), "Starting retransmit as we have unacknowledged packets (packet %i, timeout %.3f).", InLocalAck, RetransmitTimeout);
 
                 SendRaw(Packet);
+                Packet.Retransmitted = true;
+                RetransmitCount++;
+                BackoffRetransmitTimeout();
+                ShrinkCongestionWindow();
 
                 IsRetransmitting = true;
                 RetransmittingIndex = InLocalAck;
-                RetransmitPacket = Packet;
                 RetransmitAttempts = 0;
                 RetransmissionTimer = GetSeconds();
             }
         } 
     }
-    // TODO: Handle overflow - This is super crude,  do it in a better way.
     else
     {
         double ElapsedTime = (CurrentTime - RetransmissionTimer);
 
-        if (RetransmittingIndex > MAX_ACK_VALUE_TOP_QUART && SequenceIndexAcked < MAX_ACK_VALUE_BOTTOM_QUART ||
-            SequenceIndexAcked >= RetransmittingIndex)
+        if (GetSequenceDistance(SequenceIndexAcked, RetransmittingIndex) <= 0)
         {
             VerboseS(Connection->GetName().c_str(), "Recovered from retransmit.");
             IsRetransmitting = false;
         }
-        else if (ElapsedTime > RETRANSMIT_CYCLE_INTERVAL)
+        else if (ElapsedTime > RetransmitTimeout)
         {
-            LogS(Connection->GetName().c_str(), "Retransmitting packet, initial retransmit has not been acknowledged: RetransmittingIndex=%u SequenceIndexAcked=%u MAX_ACK_VALUE_TOP_QUART=%u MAX_ACK_VALUE_BOTTOM_QUART=%u RetransmitAttempts=%u ElapsedTime=%f", RetransmittingIndex, SequenceIndexAcked, MAX_ACK_VALUE_TOP_QUART, MAX_ACK_VALUE_BOTTOM_QUART, RetransmitAttempts, ElapsedTime);
+            LogS(Connection->GetName().c_str(), "Retransmitting packet, initial retransmit has not been acknowledged: RetransmittingIndex=%u SequenceIndexAcked=%u RetransmitAttempts=%u ElapsedTime=%f RetransmitTimeout=%f", RetransmittingIndex, SequenceIndexAcked, RetransmitAttempts, ElapsedTime, RetransmitTimeout);
             RetransmissionTimer = GetSeconds();
 
             RetransmitAttempts++;
@@ -738,31 +965,124 @@ void Frpg2ReliableUdpPacketStream::HandleOutgoing()
                 InErrorState = true;
                 return;
             }
+            else if (Frpg2ReliableUdpPacket* Packet = RetransmitBuffer.FindSequence(RetransmittingIndex))
+            {
+                SendRaw(*Packet);
+                RetransmitCount++;
+                BackoffRetransmitTimeout();
+                ShrinkCongestionWindow();
+            }
             else
             {
-                SendRaw(RetransmitPacket);
+                // Packet has gone from the buffer without us seeing it acked (eg. the stream was
+                // reset), so there is nothing left to retransmit.
+                VerboseS(Connection->GetName().c_str(), "Stopping retransmit as packet %u is no longer in the retransmit buffer.", RetransmittingIndex);
+                IsRetransmitting = false;
             }
         }
     }
 
-    // Do not send any packets if we have a lot of packets waiting for ack.
-    while (!IsRetransmitting && SendQueue.size() > 0 && RetransmitBuffer.size() < MAX_PACKETS_IN_FLIGHT)
+    // Send as many packets as the congestion window allows. This carries on while retransmitting,
+    // the window having been shrunk is enough to back off.
+    while (!SendQueue.Empty() && RetransmitBuffer.Size() < (size_t)CongestionWindow)
     {
-        Frpg2ReliableUdpPacket Packet = SendQueue[0];
-        SendQueue.erase(SendQueue.begin());
-        RetransmitBuffer.push_back(Packet);
-
         uint32_t InLocalAck, InRemoteAck;
-        Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
+        SendQueue.Front().Header.GetAckCounters(InLocalAck, InRemoteAck);
+
+        RetransmitBuffer.PushBack(InLocalAck, std::move(SendQueue.Front()));
+        SendQueue.PopFront();
+
+        Frpg2ReliableUdpPacket& Packet = RetransmitBuffer.Back();
+        Packet.SendTime = GetSeconds();
 
         SendRaw(Packet);
     }
+
+    UpdateRetransmitTimer();
+}
+
+void Frpg2ReliableUdpPacketStream::FastRetransmit()
+{
+    Frpg2ReliableUdpPacket& Packet = RetransmitBuffer.Front();
+
+    uint32_t InLocalAck, InRemoteAck;
+    Packet.Header.GetAckCounters(InLocalAck, InRemoteAck);
+
+    // Already being dealt with by the timeout based retransmit.
+    if (IsRetransmitting && RetransmittingIndex == InLocalAck)
+    {
+        return;
+    }
+
+    VerboseS(Connection->GetName().c_str(), "Fast retransmitting packet %i after %i duplicate acks.", InLocalAck, DuplicateAckCount);
+
+    SendRaw(Packet);
+
+    // Restart the packets timeout from now, the retransmit is as good as a fresh send.
+    Packet.SendTime = GetSeconds();
+    Packet.Retransmitted = true;
+
+    RetransmitCount++;
+    FastRetransmitCount++;
+
+    // The later packets did get through, so halve the window rather than backing off the timeout.
+    ShrinkCongestionWindow();
+    UpdateRetransmitTimer();
+}
+
+void Frpg2ReliableUdpPacketStream::UpdateRetransmitTimer()
+{
+    if (Timers == nullptr)
+    {
+        return;
+    }
+
+    if (RetransmitBuffer.Empty())
+    {
+        CancelRetransmitTimer();
+    }
+    else if (IsRetransmitting)
+    {
+        ArmRetransmitTimer(RetransmissionTimer + RetransmitTimeout);
+    }
+    else
+    {
+        ArmRetransmitTimer(RetransmitBuffer.Front().SendTime + RetransmitTimeout);
+    }
+}
+
+void Frpg2ReliableUdpPacketStream::ArmRetransmitTimer(double Deadline)
+{
+    if (RetransmitTimerHandle != TimerWheel::InvalidHandle && RetransmitTimerDeadline == Deadline)
+    {
+        return;
+    }
+
+    CancelRetransmitTimer();
+
+    std::weak_ptr<bool> WeakFired = RetransmitTimerFired;
+    RetransmitTimerHandle = Timers->Schedule(Deadline, [WeakFired]() {
+        if (std::shared_ptr<bool> Fired = WeakFired.lock())
+        {
+            *Fired = true;
+        }
+    });
+    RetransmitTimerDeadline = Deadline;
+}
+
+void Frpg2ReliableUdpPacketStream::CancelRetransmitTimer()
+{
+    if (RetransmitTimerHandle != TimerWheel::InvalidHandle)
+    {
+        Timers->Cancel(RetransmitTimerHandle);
+        RetransmitTimerHandle = TimerWheel::InvalidHandle;
+    }
 }
 
 bool Frpg2ReliableUdpPacketStream::Pump()
 {
     // Mark as connection closed after we have sent everything in the queue.
-    if (State == Frpg2ReliableUdpStreamState::Closing && SendQueue.size() == 0)
+    if (State == Frpg2ReliableUdpStreamState::Closing && SendQueue.Empty())
     {
         LogS(Connection->GetName().c_str(), "Connection closed.");
         State = Frpg2ReliableUdpStreamState::Closed;
@@ -806,9 +1126,61 @@ bool Frpg2ReliableUdpPacketStream::Pump()
     HandleIncoming();
     HandleOutgoing();
 
+    // Replies have had their chance to carry any pending ack, send it
+    // on its own if its been held long enough.
+    FlushPendingAck(false);
+
     return false;
 }
 
+double Frpg2ReliableUdpPacketStream::GetNextPollTime()
+{
+    double CurrentTime = GetSeconds();
+    double NextPollTime = std::numeric_limits<double>::max();
+
+    auto Consider = [&NextPollTime](double Time) {
+        if (Time < NextPollTime)
+        {
+            NextPollTime = Time;
+        }
+    };
+
+    // Packets waiting on room in the congestion window go out as soon as we can send them.
+    if (!SendQueue.Empty() && RetransmitBuffer.Size() < (size_t)CongestionWindow)
+    {
+        Consider(CurrentTime);
+    }
+
+    if (AckPending)
+    {
+        Consider(PendingAckDeadline);
+    }
+
+    // Retransmits are scheduled on the timer wheel when we have one.
+    if (Timers == nullptr && !RetransmitBuffer.Empty())
+    {
+        if (IsRetransmitting)
+        {
+            Consider(RetransmissionTimer + RetransmitTimeout);
+        }
+        else
+        {
+            Consider(RetransmitBuffer.Front().SendTime + RetransmitTimeout);
+        }
+    }
+
+    if (State == Frpg2ReliableUdpStreamState::Connecting)
+    {
+        Consider(ResendSynTimer + RESEND_SYN_INTERVAL);
+    }
+    else if (State == Frpg2ReliableUdpStreamState::Closing && CloseTimer > 0.0f)
+    {
+        Consider(CloseTimer + CONNECTION_CLOSE_TIMEOUT);
+    }
+
+    return NextPollTime;
+}
+
 void Frpg2ReliableUdpPacketStream::EmitDebugInfo(bool Incoming, const Frpg2ReliableUdpPacket& Packet)
 {
     uint32_t Local, Remote;
@@ -837,7 +1209,7 @@ void Frpg2ReliableUdpPacketStream::HandledPacket(uint32_t AckSequence)
     }
     else
     {
-        Send_ACK(AckSequence);
+        Queue_ACK(AckSequence);
     }
 }
 
@@ -859,7 +1231,7 @@ std::string Frpg2ReliableUdpPacketStream::Disassemble(const Frpg2ReliableUdpPack
         Message.Header.opcode != Frpg2ReliableUdpOpCode::DAT_ACK)
     {
         Result += "Packet Payload:\n";
-        Result += BytesToString(Message.Payload, "\t");
+        Result += BytesToString(Message.Payload.ToVector(), "\t");
     }
     return Result;
 }
\ No newline at end of file
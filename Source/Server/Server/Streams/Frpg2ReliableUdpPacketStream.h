@@ -12,12 +12,41 @@
 #include "Server/Streams/Frpg2UdpPacketStream.h"
 #include "Server/Streams/Frpg2ReliableUdpPacket.h"
 
+#include "Core/Utils/RingBuffer.h"
+#include "Core/Utils/TimerWheel.h"
+
 #include <unordered_set>
+#include <memory>
 
 struct Frpg2ReliableUdpPacket;
 class RSAKeyPair;
 class Cipher;
 
+struct Frpg2ReliableUdpPacketStreamStatistics
+{
+    // Round trip time estimates, these are 0 until the first packet is acknowledged.
+    double SmoothedRtt = 0.0;
+    double RttVariance = 0.0;
+
+    // Time we currently wait for an ack before retransmitting, including any backoff.
+    double RetransmitTimeout = 0.0;
+
+    // Maximum number of unacknowledged packets we currently allow in flight.
+    double CongestionWindow = 0.0;
+
+    uint64_t Retransmits = 0;
+
+    // How many of the retransmits were triggered by duplicate acks rather than a timeout.
+    uint64_t FastRetransmits = 0;
+
+    // Number of standalone ACK datagrams sent, and the number of acks that didn't need
+    // their own datagram as they were merged into a later ack or carried by an outgoing 
+    // DAT_ACK/HBT. The last two are the datagrams saved by delaying acks.
+    uint64_t AcksSent = 0;
+    uint64_t AcksCoalesced = 0;
+    uint64_t AcksPiggybacked = 0;
+};
+
 // This packet stream handles the core reliable udp packet 
 // transmission. Higher level functionality like packet fragmentation,
 // compression, etc is all handled at the higher level 
@@ -30,13 +59,14 @@ public:
     Frpg2ReliableUdpPacketStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient = false);
 
     // Returns true if send was successful, if false is returned the send queue
-    // is likely saturated or the packet is invalid.
-    virtual bool Send(const Frpg2ReliableUdpPacket& Packet);
+    // is saturated or the packet is invalid. The packets payload is taken by the 
+    // stream (it gets encrypted in place when sent), so it shouldn't be used afterwards.
+    virtual bool Send(Frpg2ReliableUdpPacket& Packet);
 
     // Notifies us that a packet has been handled and if a reply has been sent or not. This
     // allows us to know if we can now send an ACK for it or not. This is janky and only required
     // because of the stupid difference between ACK and DAT_ACK.
-    void HandledPacket(uint32_t AckSequence);
+    virtual void HandledPacket(uint32_t AckSequence);
 
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     virtual bool Recieve(Frpg2ReliableUdpPacket* Packet);
@@ -44,6 +74,11 @@ public:
     // Overridden so we can do package retransmission/general management.
     virtual bool Pump() override;
 
+    // Gets the time the stream next needs pumping if nothing is recieved before then (to send queued 
+    // packets, flush delayed acks, retransmit, etc). Retransmits scheduled on the timer wheel are not
+    // included, the wheels owner is expected to wake up for those itself.
+    double GetNextPollTime();
+
     // Gets the current connection state of this message stream.
     Frpg2ReliableUdpStreamState GetState() { return State; }
 
@@ -51,15 +86,28 @@ public:
     void Connect(const std::string& ClientSteamId);
 
     // Attempts to do a graceful disconnect so the remote end doesn't send us messages in future.
-    void Disconnect();
+    virtual void Disconnect();
+
+    // Gets the round trip/retransmission statistics of this stream.
+    virtual Frpg2ReliableUdpPacketStreamStatistics GetStatistics();
 
     // Diassembles a messages into a human-readable string.
     std::string Disassemble(const Frpg2ReliableUdpPacket& Packet);
 
+    // Schedules retransmit checks on the given wheel rather than checking the
+    // retransmit buffer every pump. The wheel must be advanced by the same thread
+    // that pumps this stream.
+    void SetTimerWheel(TimerWheel* InTimers) { Timers = InTimers; }
+
+    // Sets how long (in seconds) acks are held on to before being sent in their own
+    // datagram. Any reply sent in the meantime carries the ack instead, and acks
+    // that queue up behind each other are sent as one. 0 sends acks immediately.
+    void SetAckDelay(double InAckDelay) { AckDelay = InAckDelay; }
+
 protected:
 
     bool DecodeReliablePacket(const Frpg2UdpPacket& Packet, Frpg2ReliableUdpPacket& Message);
-    bool EncodeReliablePacket(const Frpg2ReliableUdpPacket& Message, Frpg2UdpPacket& Packet);
+    bool EncodeReliablePacket(Frpg2ReliableUdpPacket& Message, Frpg2UdpPacket& Packet);
 
     void HandleIncoming();
     void HandleIncomingPacket(const Frpg2ReliableUdpPacket& Packet);
@@ -67,6 +115,18 @@ protected:
 
     void HandleOutgoing();
 
+    // Keeps the retransmit timer in step with the oldest unacked packet and the current
+    // retransmit timeout. Needs calling whenever either of those change.
+    void UpdateRetransmitTimer();
+    void ArmRetransmitTimer(double Deadline);
+    void CancelRetransmitTimer();
+
+    void UpdateRoundTripTime(double Sample);
+    void BackoffRetransmitTimeout();
+
+    void GrowCongestionWindow(size_t AckedPackets);
+    void ShrinkCongestionWindow();
+
     void Handle_SYN(const Frpg2ReliableUdpPacket& Packet);
     void Handle_SYN_ACK(const Frpg2ReliableUdpPacket& Packet);
     void Handle_DAT(const Frpg2ReliableUdpPacket& Packet);
@@ -78,17 +138,32 @@ protected:
     void Handle_ACK(const Frpg2ReliableUdpPacket& Packet);
     void Handle_RACK(const Frpg2ReliableUdpPacket& Packet);
 
-    bool SendRaw(const Frpg2ReliableUdpPacket& Packet);
+    bool SendRaw(Frpg2ReliableUdpPacket& Packet);
 
     void Send_SYN();
     void Send_SYN_ACK(uint32_t RemoteIndex);
     void Send_ACK(uint32_t RemoteIndex);
+    void Queue_ACK(uint32_t RemoteIndex);
+    void FlushPendingAck(bool Force);
     void Send_DAT_ACK(uint32_t LocalIndex, uint32_t RemoteIndex);
     void Send_FIN_ACK(uint32_t RemoteIndex);
     void Send_FIN();
     void Send_HBT();
 
-    int GetPacketIndexByLocalSequence(const std::vector<Frpg2ReliableUdpPacket>& Queue, uint32_t SequenceIndex);
+    // Serial number arithmetic (RFC 1982) over the 12 bit sequence space. Returns how far
+    // To is ahead of From, or a negative value if it is behind.
+    int GetSequenceDistance(uint32_t From, uint32_t To);
+
+    // Advances SequenceIndexAcked if the ack covers packets we have sent but not yet had acked.
+    // Returns true if it was advanced. ArrivalTime is when the packet carrying the ack was recieved.
+    bool UpdateSequenceIndexAcked(uint32_t Ack, double ArrivalTime);
+
+    // Removes newly acked packets from the retransmit buffer, sampling the round trip time 
+    // and growing the congestion window.
+    void ReleaseAckedPackets(double ArrivalTime);
+
+    // Resends the oldest unacknowledged packet without waiting for its retransmit timeout.
+    void FastRetransmit();
 
     bool IsOpcodeSequenced(Frpg2ReliableUdpOpCode Opcode);
 
@@ -114,8 +189,7 @@ protected:
     // DAT packets that we except to reply to with a DAT_ACK.
     std::unordered_set<uint32_t> ExpectedDatAckResponses;
 
-    // TODO: Need to handle these rolling over. They have 12 bits so 
-    //       it shouldn't happen for a while, but still needs fixing.
+    // All sequence indices are 12 bits and roll over, compare them with GetSequenceDistance.
 
     uint32_t SequenceIndex = START_SEQUENCE_INDEX;
     uint32_t SequenceIndexAcked = 0;
@@ -123,40 +197,74 @@ protected:
     uint32_t RemoteSequenceIndex = 0;
     uint32_t RemoteSequenceIndexAcked = 0;
 
+    // Delayed ack waiting to be sent, see SetAckDelay. Acks are cumulative
+    // so only the latest index needs to be held on to.
+    double AckDelay = 0.0;
+    bool AckPending = false;
+    uint32_t PendingAckIndex = 0;
+    double PendingAckDeadline = 0.0;
+
+    // Number of ACKs in a row that have acked no further than SequenceIndexAcked
+    // while we have packets in flight.
+    uint32_t DuplicateAckCount = 0;
+
     bool IsRetransmitting = false;
     uint32_t RetransmittingIndex = 0;
     double RetransmissionTimer = 0.0;
     uint32_t RetransmitAttempts = 0;
-    Frpg2ReliableUdpPacket RetransmitPacket;
 
-    // TODO: All these should be shared pointers or something, we do way
-    //       too much data shuffling with raw packets.
+    // All the queues below are fixed size and reuse their packet slots, so steady 
+    // state traffic doesn't need to grow them.
 
-    // Packets that have been recieved and are awaiting processing. They will
-    // stay in this queue until they are the next in the remote sequence index.
-    std::vector<Frpg2ReliableUdpPacket> PendingRecieveQueue;
+    // Sequenced packets that have been recieved ahead of the next remote sequence index, indexed
+    // by sequence index modulo REORDER_BUFFER_SIZE. They are processed in order once the gap 
+    // before them has been filled.
+    std::vector<Frpg2ReliableUdpPacket> ReorderBuffer;
+    std::vector<bool> ReorderBufferOccupied;
 
-    // Ordered packets read for whoever calls Recieve() to handle.
-    std::vector<Frpg2ReliableUdpPacket> RecieveQueue;
+    // Ordered packets read for whoever calls Recieve() to handle. If this fills up we stop
+    // processing the reorder buffer until its drained.
+    RingBuffer<Frpg2ReliableUdpPacket> RecieveQueue;
 
     // Packets that are queued to send, will be sent when transmission is permitted.
-    std::vector<Frpg2ReliableUdpPacket> SendQueue;
+    RingBuffer<Frpg2ReliableUdpPacket> SendQueue;
 
     // Queue of packets that have been send but not acknowledged yet, held on to 
-    // until they have been acked.
-    std::vector<Frpg2ReliableUdpPacket> RetransmitBuffer; // Use priority queue.
+    // until they have been acked. Pushed with their sequence index so any unacked
+    // packet can be found with FindSequence, its capacity divides MAX_ACK_VALUE so 
+    // this holds across the sequence index wrapping.
+    RingBuffer<Frpg2ReliableUdpPacket> RetransmitBuffer;
+
+    // RetransmitBuffer followed by SendQueue always hold a contiguous run of sequence 
+    // indices starting at SequenceIndexAcked + 1.
 
     double ResendSynTimer = 0.0;
 
-    // We stop sending packets and queue them up until we start recieving acks.
-    const int MAX_PACKETS_IN_FLIGHT = 20;
+    TimerWheel* Timers = nullptr;
 
-    // We reeeeeeeaaaallly want this to be exponential backoff, but this works for now.
-    const float RETRANSMIT_INTERVAL = 5.0;
+    // Set when the retransmit timer fires. The wheel only holds a weak reference to 
+    // this so the stream can be destroyed while a timer is still scheduled.
+    std::shared_ptr<bool> RetransmitTimerFired = std::make_shared<bool>(false);
+    TimerWheel::Handle RetransmitTimerHandle = TimerWheel::InvalidHandle;
+    double RetransmitTimerDeadline = 0.0;
 
-    const float RETRANSMIT_CYCLE_INTERVAL = 0.5;
+    // The retransmit timeout is calculated from the measured round trip time as
+    // in RFC 6298, and doubled each time a retransmit goes unacknowledged.
+    const double INITIAL_RETRANSMIT_TIMEOUT = 1.0;
+    const double MIN_RETRANSMIT_TIMEOUT = 0.2;
+    const double MAX_RETRANSMIT_TIMEOUT = 5.0;
 
-    const uint32_t RETRANSMIT_MAX_ATTEMPTS = 32;
+    // Gains used when smoothing the round trip time and its variance.
+    const double RTT_ALPHA = 1.0 / 8.0;
+    const double RTT_BETA = 1.0 / 4.0;
+
+    // With backoff this gives the connection around 20-30 seconds to recover.
+    const uint32_t RETRANSMIT_MAX_ATTEMPTS = 8;
+
+    // The remote acks each packet it recieves, so duplicate acks while we have later packets 
+    // in flight mean those are arriving and the oldest one has likely been lost. After this
+    // many we retransmit it straight away rather than waiting for the timeout (as in TCP).
+    const uint32_t FAST_RETRANSMIT_DUPLICATE_ACKS = 3;
 
     const float RESEND_SYN_INTERVAL = 0.5f;
 
@@ -168,16 +276,41 @@ protected:
     // How many values ACK increases before it rolls over.
     const uint32_t MAX_ACK_VALUE = 4096;
 
-    // Top quater ack range, used to handle overflows.
-    const uint32_t MAX_ACK_VALUE_TOP_QUART = (4096 / 4) * 3;
+    // How far ahead of the next expected sequence index we will buffer packets that arrive
+    // out of order, anything further ahead is dropped.
+    const uint32_t REORDER_BUFFER_SIZE = 256;
 
-    // Bottom quater ack range, used to handle overflows.
-    const uint32_t MAX_ACK_VALUE_BOTTOM_QUART = (4096 / 4) * 1;
+    // Maximum number of packets waiting to be sent. Along with the congestion window 
+    // this keeps all unacknowledged packets within half the sequence space.
+    const uint32_t SEND_QUEUE_SIZE = (MAX_ACK_VALUE / 4) - 1;
 
     // Starting sequence index. TCP protocol expects this to be 
     // randomised but there isn't really any benefit to that.
     const uint32_t START_SEQUENCE_INDEX = 4000;
 
+    // Bounds of the congestion window, in packets. The window grows as packets are 
+    // acknowledged (exponentially until the slow start threshold, linearly after) 
+    // and is halved when a packet has to be retransmitted. The upper bound keeps
+    // everything in flight well within half the sequence space, which serial number
+    // comparisons of sequence indices rely on.
+    const double INITIAL_CONGESTION_WINDOW = 20.0;
+    const double MIN_CONGESTION_WINDOW = 2.0;
+    const double MAX_CONGESTION_WINDOW = MAX_ACK_VALUE / 4;
+
     double CloseTimer = 0.0f;
 
+    double SmoothedRtt = 0.0;
+    double RttVariance = 0.0;
+    bool HasRttSample = false;
+    double RetransmitTimeout = INITIAL_RETRANSMIT_TIMEOUT;
+    uint64_t RetransmitCount = 0;
+    uint64_t FastRetransmitCount = 0;
+
+    uint64_t AcksSentCount = 0;
+    uint64_t AcksCoalescedCount = 0;
+    uint64_t AcksPiggybackedCount = 0;
+
+    double CongestionWindow = INITIAL_CONGESTION_WINDOW;
+    double SlowStartThreshold = MAX_CONGESTION_WINDOW;
+
 };
\ No newline at end of file
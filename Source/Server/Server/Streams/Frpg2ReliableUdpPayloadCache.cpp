@@ -0,0 +1,84 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#include "Server/Streams/Frpg2ReliableUdpPayloadCache.h"
+
+#include "Core/Utils/Compression.h"
+
+#include <string_view>
+#include <cstring>
+
+Frpg2ReliableUdpPayloadCache::Frpg2ReliableUdpPayloadCache(size_t InMaxEntries)
+    : MaxEntries(InMaxEntries)
+{
+}
+
+Frpg2ReliableUdpPayloadCache::CompressedPayload Frpg2ReliableUdpPayloadCache::GetCompressed(const uint8_t* Data, size_t Size)
+{
+    size_t Hash = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(Data), Size));
+
+    {
+        std::scoped_lock lock(CacheMutex);
+
+        auto Range = Entries.equal_range(Hash);
+        for (auto iter = Range.first; iter != Range.second; iter++)
+        {
+            Entry& CacheEntry = iter->second;
+            if (CacheEntry.Uncompressed.size() == Size && memcmp(CacheEntry.Uncompressed.data(), Data, Size) == 0)
+            {
+                CacheEntry.LastUsed = ++UseCounter;
+                HitCount++;
+                return CacheEntry.Compressed;
+            }
+        }
+    }
+
+    // Compress outside the lock, if another thread gets here with the same payload 
+    // at the same time we will just end up with a duplicate entry.
+    std::shared_ptr<std::vector<uint8_t>> Compressed = std::make_shared<std::vector<uint8_t>>();
+    if (!Compress(Data, Size, *Compressed))
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock lock(CacheMutex);
+
+    MissCount++;
+
+    if (Entries.size() >= MaxEntries)
+    {
+        EvictOldest();
+    }
+
+    Entry NewEntry;
+    NewEntry.Uncompressed.assign(Data, Data + Size);
+    NewEntry.Compressed = Compressed;
+    NewEntry.LastUsed = ++UseCounter;
+    Entries.insert({ Hash, std::move(NewEntry) });
+
+    return Compressed;
+}
+
+void Frpg2ReliableUdpPayloadCache::EvictOldest()
+{
+    // Cache is small enough that a linear search is fine.
+    auto Oldest = Entries.end();
+    for (auto iter = Entries.begin(); iter != Entries.end(); iter++)
+    {
+        if (Oldest == Entries.end() || iter->second.LastUsed < Oldest->second.LastUsed)
+        {
+            Oldest = iter;
+        }
+    }
+
+    if (Oldest != Entries.end())
+    {
+        Entries.erase(Oldest);
+    }
+}
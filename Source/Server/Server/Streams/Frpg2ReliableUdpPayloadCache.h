@@ -0,0 +1,66 @@
+/*
+ * Dark Souls 3 - Open Server
+ * Copyright (C) 2021 Tim Leonard
+ *
+ * This program is free software; licensed under the MIT license.
+ * You should have received a copy of the license along with this program.
+ * If not, see <https://opensource.org/licenses/MIT>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Some payloads are sent byte-for-byte identically to lots of clients (announcements, 
+// upload config, etc). Rather than deflating them again for every client, the fragment
+// stream can look them up in this cache, which holds the compressed version of recently 
+// sent payloads keyed by their uncompressed contents. The stream then only has to cut the 
+// compressed data into fragments, add its headers and encrypt.
+//
+// The cache is shared between all streams and is safe to use from multiple threads.
+
+class Frpg2ReliableUdpPayloadCache
+{
+public:
+    using CompressedPayload = std::shared_ptr<const std::vector<uint8_t>>;
+
+    Frpg2ReliableUdpPayloadCache(size_t InMaxEntries);
+
+    // Gets the compressed version of the given payload, compressing and storing it 
+    // if not already cached. Returns nullptr if compression fails.
+    CompressedPayload GetCompressed(const uint8_t* Data, size_t Size);
+
+    size_t GetHitCount()    { return HitCount; }
+    size_t GetMissCount()   { return MissCount; }
+
+private:
+    struct Entry
+    {
+        std::vector<uint8_t> Uncompressed;
+        CompressedPayload Compressed;
+        uint64_t LastUsed = 0;
+    };
+
+    void EvictOldest();
+
+private:
+    size_t MaxEntries;
+
+    std::mutex CacheMutex;
+
+    // Keyed by hash of the uncompressed payload, entries with the same hash are 
+    // compared byte by byte.
+    std::unordered_multimap<size_t, Entry> Entries;
+
+    uint64_t UseCounter = 0;
+
+    // Atomic so the statistics can be read without taking the cache lock.
+    std::atomic<size_t> HitCount = 0;
+    std::atomic<size_t> MissCount = 0;
+
+};
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Core/Utils/Endian.h"
+#include "Core/Utils/PacketBuffer.h"
 
 #include <vector>
 #include <string>
@@ -19,10 +20,13 @@ struct Frpg2UdpPacket
 public:
 
     // Length is equal to the rest of the payload minus the header.
-    std::vector<uint8_t> Payload;
+    PacketBuffer Payload;
 
     std::string Disassembly;
 
     bool HasConnectionPrefix = false;
 
+    // Time (as returned by GetSeconds) the packet was recieved.
+    double RecieveTime = 0.0;
+
 };
\ No newline at end of file
@@ -38,8 +38,6 @@ Frpg2UdpPacketStream::Frpg2UdpPacketStream(std::shared_ptr<NetConnection> InConn
         DecryptionCipher = std::make_shared<CWCClientUDPCipher>(InCwcKey, AuthToken);
     }
 
-    RecieveBuffer.resize(64 * 1024);
-
     LastActivityTime = GetSeconds();
 }
 
@@ -55,38 +53,31 @@ bool Frpg2UdpPacketStream::Pump()
     // Recieve any pending packets.
     while (true)
     {
-        int BytesRecieved = 0;
-        RecieveBuffer.resize(RecieveBuffer.capacity());
-        if (!Connection->Recieve(RecieveBuffer, 0, (int)RecieveBuffer.size(), BytesRecieved))
+        // The connection hands over the datagram it recieved, it's decrypted in place and 
+        // then passed up the stream stack without being copied.
+        Frpg2UdpPacket Packet;
+        if (!Connection->Recieve(Packet.Payload))
         {
             WarningS(Connection->GetName().c_str(), "Failed to recieve on connection.");
             InErrorState = true;
             return true;
         }
 
-        if (BytesRecieved > 0)
+        if (!Packet.Payload.Empty())
         {
             LastActivityTime = GetSeconds();
 
-            RecieveBuffer.resize(BytesRecieved);
-
-            Frpg2UdpPacket Packet;
-            if (!BytesToPacket(RecieveBuffer, Packet))
-            {
-                WarningS(Connection->GetName().c_str(), "Failed to parse recieved packet.");
-                InErrorState = true;
-                return true;
-            }
-
+            Packet.RecieveTime = LastActivityTime;
             if (DecryptionCipher)
             {        
-                std::vector<uint8_t> EncryptedBuffer = Packet.Payload;
-                if (!DecryptionCipher->Decrypt(EncryptedBuffer, Packet.Payload))
+                if (!DecryptionCipher->DecryptInPlace(Packet.Payload.Data(), Packet.Payload.Size()))
                 {
                     WarningS(Connection->GetName().c_str(), "Failed to decrypt packet payload.");
                     InErrorState = true;
                     return false;
                 }
+
+                Packet.Payload.Strip(DecryptionCipher->GetHeaderSize());
             }
 
            /* static bool dumped = false;
@@ -96,7 +87,7 @@ bool Frpg2UdpPacketStream::Pump()
                 WriteBytesToFile("Z:\\ds3os\\Research\\Packet Traces\\game_login_compare\\from-game.dat", Packet.Payload);
             }*/
 
-            RecieveQueue.push_back(Packet);
+            RecieveQueue.push_back(std::move(Packet));
         }
         else
         {
@@ -107,40 +98,49 @@ bool Frpg2UdpPacketStream::Pump()
     return false;
 }
 
-bool Frpg2UdpPacketStream::Send(const Frpg2UdpPacket& Packet)
+bool Frpg2UdpPacketStream::Send(Frpg2UdpPacket& Packet)
 {
-    Frpg2UdpPacket SendPacket = Packet;
+    if (!EncryptionCipher)
+    {
+        return SendBytes(Packet.Payload);
+    }
+
+    size_t HeaderSize = EncryptionCipher->GetHeaderSize();
 
-    std::vector<uint8_t> DecryptedBuffer = SendPacket.Payload;
-    if (EncryptionCipher)
+    // If nobody else references the payload we can just encrypt it where it is, with the cipher 
+    // header going into the headroom. Otherwise it's copied into a new buffer and encrypted there,
+    // either way the packet is left holding the encrypted datagram.
+    Packet.Payload.MakeUnique();
+
+    size_t SendSize = HeaderSize + Packet.Payload.Size();
+    uint8_t* CipherText = Packet.Payload.Prepend(HeaderSize);
+
+    if (Packet.HasConnectionPrefix)
     {
-        if (SendPacket.HasConnectionPrefix)
-        {
-            dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(true);
-        }
+        dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(true);
+    }
 
-        if (!EncryptionCipher->Encrypt(DecryptedBuffer, SendPacket.Payload))
-        {
-            WarningS(Connection->GetName().c_str(), "Failed to encrypt packet payload.");
-            InErrorState = true;
-            return false;
-        }
+    bool bEncrypted = EncryptionCipher->EncryptInPlace(CipherText, SendSize);
 
-        if (SendPacket.HasConnectionPrefix)
-        {
-            dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(false);
-        }
+    if (Packet.HasConnectionPrefix)
+    {
+        dynamic_cast<CWCClientUDPCipher*>(EncryptionCipher.get())->SetPacketsHaveConnectionPrefix(false);
     }
 
-    std::vector<uint8_t> Bytes;
-    if (!PacketToBytes(SendPacket, Bytes))
+    if (!bEncrypted)
     {
-        WarningS(Connection->GetName().c_str(), "Failed to send packet, unable to serialize.");
+        WarningS(Connection->GetName().c_str(), "Failed to encrypt packet payload.");
         InErrorState = true;
         return false;
     }
 
-    if (!Connection->Send(Bytes, 0, (int)Bytes.size()))
+    // The connection may hold onto the payload until it next flushes rather than copying it.
+    return SendBytes(Packet.Payload);
+}
+
+bool Frpg2UdpPacketStream::SendBytes(const PacketBuffer& Buffer)
+{
+    if (!Connection->Send(Buffer))
     {
         WarningS(Connection->GetName().c_str(), "Failed to send packet.");
         InErrorState = true;
@@ -157,27 +157,8 @@ bool Frpg2UdpPacketStream::Recieve(Frpg2UdpPacket* OutputPacket)
         return false;
     }
 
-    *OutputPacket = RecieveQueue[0];
+    *OutputPacket = std::move(RecieveQueue[0]);
     RecieveQueue.erase(RecieveQueue.begin());
 
     return true;
 }
-
-bool Frpg2UdpPacketStream::BytesToPacket(const std::vector<uint8_t>& Buffer, Frpg2UdpPacket& Packet)
-{
-    int PayloadSize = (int)Buffer.size();
-
-    Packet.Payload.resize(PayloadSize);
-    memcpy(Packet.Payload.data(), Buffer.data(), PayloadSize);
-
-    return true;
-}
-
-bool Frpg2UdpPacketStream::PacketToBytes(const Frpg2UdpPacket& Packet, std::vector<uint8_t>& Buffer)
-{
-    Buffer.resize(Packet.Payload.size());
-
-    memcpy(Buffer.data(), Packet.Payload.data(), Packet.Payload.size());
-
-    return true;
-}
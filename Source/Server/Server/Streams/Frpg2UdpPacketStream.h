@@ -23,8 +23,10 @@ public:
     Frpg2UdpPacketStream(std::shared_ptr<NetConnection> Connection, const std::vector<uint8_t>& CwcKey, uint64_t AuthToken, bool AsClient = false);
 
     // Returns true if send was successful, if false is returned the send queue
-    // is likely saturated or the packet is invalid.
-    bool Send(const Frpg2UdpPacket& Packet);
+    // is likely saturated or the packet is invalid. The packets payload is encrypted
+    // in place if nothing else references it, either way it's left holding the encrypted 
+    // datagram that was sent, which must not be modified.
+    bool Send(Frpg2UdpPacket& Packet);
 
     // Returns true if a packet was recieved and stores packet in OutputPacket.
     bool Recieve(Frpg2UdpPacket* Packet);
@@ -39,8 +41,7 @@ public:
 
 protected:
 
-    bool BytesToPacket(const std::vector<uint8_t>& Buffer, Frpg2UdpPacket& Packet);
-    bool PacketToBytes(const Frpg2UdpPacket& Packet, std::vector<uint8_t>& Buffer);
+    bool SendBytes(const PacketBuffer& Buffer);
 
 protected:
 
@@ -57,8 +58,6 @@ private:
 
     std::vector<Frpg2UdpPacket> RecieveQueue;
 
-    std::vector<uint8_t> RecieveBuffer;
-
     std::shared_ptr<Cipher> EncryptionCipher;
     std::shared_ptr<Cipher> DecryptionCipher;
 };
\ No newline at end of file
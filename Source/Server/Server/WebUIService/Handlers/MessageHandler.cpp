@@ -47,6 +47,7 @@ bool MessageHandler::handlePost(CivetServer* Server, struct mg_connection* Conne
     std::string message = json["message"];
 
     std::shared_ptr<GameService> Game = Service->GetServer()->GetService<GameService>();
+    std::scoped_lock GameLock(Game->GetStateMutex());
     if (playerId == 0)
     {
         LogS("WebUI", "Sending message to all players: %s", message.c_str());
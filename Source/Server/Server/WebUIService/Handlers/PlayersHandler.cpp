@@ -10,6 +10,7 @@
 #include "Server/Server.h"
 #include "Server/GameService/GameService.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
 #include "Server/WebUIService/Handlers/PlayersHandler.h"
 #include "Server/Core/Network/NetConnection.h"
 
@@ -31,6 +32,7 @@ void PlayersHandler::GatherData()
     std::scoped_lock lock(DataMutex);
 
     std::shared_ptr<GameService> Game = Service->GetServer()->GetService<GameService>();
+    std::scoped_lock GameLock(Game->GetStateMutex());
     std::vector<std::shared_ptr<GameClient>> Clients = Game->GetClients();
 
     PlayerInfos.clear();
@@ -39,6 +41,10 @@ void PlayersHandler::GatherData()
         PlayerInfo Info;
         Info.State = Client->GetPlayerState();
         Info.ConnectionDuration = Client->GetConnectionDuration();
+
+        Frpg2ReliableUdpPacketStreamStatistics StreamStatistics = Client->MessageStream->GetStatistics();
+        Info.RoundTripTime = StreamStatistics.SmoothedRtt;
+        Info.RetransmitTimeout = StreamStatistics.RetransmitTimeout;
         PlayerInfos.push_back(Info);
     }
 }
@@ -197,6 +203,8 @@ bool PlayersHandler::handleGet(CivetServer* Server, struct mg_connection* Connec
 
             playerJson["connectionTime"] = SecondsToString(Info.ConnectionDuration);
             playerJson["playTime"] = SecondsToString(Info.State.PlayerStatus.play_data().play_time_seconds());
+            playerJson["ping"] = (int)(Info.RoundTripTime * 1000.0);
+            playerJson["retransmitTimeout"] = (int)(Info.RetransmitTimeout * 1000.0);
 
             playerArray.push_back(playerJson);
         }
@@ -231,6 +239,7 @@ bool PlayersHandler::handleDelete(CivetServer* Server, struct mg_connection* Con
 
     ServerDatabase& Database = Service->GetServer()->GetDatabase();
     std::shared_ptr<GameService> Game = Service->GetServer()->GetService<GameService>();    
+    std::scoped_lock GameLock(Game->GetStateMutex());
     if (std::shared_ptr<GameClient> Client = Game->FindClientByPlayerId(playerId))
     {
         if (ban)
@@ -245,6 +254,7 @@ bool PlayersHandler::handleDelete(CivetServer* Server, struct mg_connection* Con
         }
 
         Client->Connection->Disconnect();
+        Game->WakeShard(Client->ShardIndex);
     }
 
     nlohmann::json responseJson;
@@ -36,6 +36,8 @@ protected:
 	{
 		PlayerState State; 
 		double ConnectionDuration;
+		double RoundTripTime;
+		double RetransmitTimeout;
 	};
 
 	std::mutex DataMutex;
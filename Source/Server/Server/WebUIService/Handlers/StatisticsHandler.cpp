@@ -10,13 +10,18 @@
 #include "Server/WebUIService/Handlers/StatisticsHandler.h"
 #include "Server/Server.h"
 #include "Server/GameService/GameService.h"
+#include "Server/AuthService/AuthService.h"
 #include "Server/GameService/GameClient.h"
+#include "Server/Streams/Frpg2ReliableUdpMessageStream.h"
+#include "Server/Streams/Frpg2ProtobufPool.h"
 #include "Server/GameService/GameManagers/BloodMessage/BloodMessageManager.h"
 #include "Server/GameService/GameManagers/Bloodstain/BloodstainManager.h"
 #include "Server/GameService/GameManagers/QuickMatch/QuickMatchManager.h"
 #include "Server/GameService/GameManagers/Signs/SignManager.h"
 #include "Server/GameService/GameManagers/Ghosts/GhostManager.h"
 
+#include "Core/Network/NetConnectionUDP.h"
+
 #include "Core/Utils/Logging.h"
 #include "Core/Utils/Strings.h"
 
@@ -37,6 +42,7 @@ void StatisticsHandler::GatherData()
     std::scoped_lock lock(DataMutex);
 
     std::shared_ptr<GameService> Game = Service->GetServer()->GetService<GameService>();
+    std::scoped_lock GameLock(Game->GetStateMutex());
     std::vector<std::shared_ptr<GameClient>> Clients = Game->GetClients();
 
     // Grab record of statistics over time.
@@ -82,6 +88,44 @@ void StatisticsHandler::GatherData()
     Statistics["Live Ghosts"] = Ghosts->GetLiveCount();
     Statistics["Update Time (MS)"] = static_cast<size_t>(Service->GetServer()->GetUpdateTime() * 1000.0f);
 
+    NetConnectionUDPStatistics NetStats = Game->GetConnectionStatistics();
+    Statistics["Game Datagrams Per Recieve Call (x100)"] = NetStats.RecieveCalls > 0 ? (NetStats.DatagramsRecieved * 100) / NetStats.RecieveCalls : 0;
+    Statistics["Game Datagrams Per Send Call (x100)"] = NetStats.SendCalls > 0 ? (NetStats.DatagramsSent * 100) / NetStats.SendCalls : 0;
+    Statistics["Game Datagrams Rate Limited"] = NetStats.DatagramsRateLimited;
+    Statistics["Game Datagrams Rejected"] = NetStats.DatagramsRejected;
+    Statistics["Game Datagrams Send Dropped"] = NetStats.DatagramsSendDropped;
+    Statistics["Game Socket Drain Time (US)"] = static_cast<size_t>(NetStats.LastDrainTime * 1000000.0);
+    Statistics["Game Socket Peak Drain Time (US)"] = static_cast<size_t>(NetStats.PeakDrainTime * 1000000.0);
+
+    size_t AcksSent = 0;
+    size_t AckDatagramsSaved = 0;
+    for (auto& Client : Clients)
+    {
+        Frpg2ReliableUdpPacketStreamStatistics StreamStatistics = Client->MessageStream->GetStatistics();
+        AcksSent += StreamStatistics.AcksSent;
+        AckDatagramsSaved += StreamStatistics.AcksCoalesced + StreamStatistics.AcksPiggybacked;
+    }
+    Statistics["Game Ack Datagrams Sent"] = AcksSent;
+    Statistics["Game Ack Datagrams Saved"] = AckDatagramsSaved;
+
+    Frpg2ReliableUdpPayloadCache& PayloadCache = Game->GetPayloadCache();
+    Statistics["Game Payload Cache Hits"] = PayloadCache.GetHitCount();
+    Statistics["Game Payload Cache Misses"] = PayloadCache.GetMissCount();
+
+    Frpg2ProtobufPoolStatistics ProtobufPoolStats = Frpg2ProtobufPool::GetStatistics();
+    Statistics["Game Protobuf Allocations"] = ProtobufPoolStats.Allocations;
+    Statistics["Game Protobuf Reuses"] = ProtobufPoolStats.Reuses;
+    Statistics["Game Protobufs Pooled"] = ProtobufPoolStats.Pooled;
+
+    AuthServiceStatistics AuthStats = Service->GetServer()->GetService<AuthService>()->GetStatistics();
+    Statistics["Auth Handshakes Completed"] = AuthStats.HandshakesCompleted;
+    Statistics["Auth Handshake Average Time (MS)"] = static_cast<size_t>(AuthStats.AverageHandshakeTime * 1000.0);
+    Statistics["Auth Handshake Peak Time (MS)"] = static_cast<size_t>(AuthStats.PeakHandshakeTime * 1000.0);
+    Statistics["Auth Worker Queue Depth"] = AuthStats.WorkerQueueDepth;
+    Statistics["Auth Worker Peak Queue Depth"] = AuthStats.PeakWorkerQueueDepth;
+
+    MessageHandlers = Game->GetMessageDispatcher().GetStatistics();
+
     // Grab some populated areas stats.
     PopulatedAreas.clear();
     for (auto& Client : Clients)
@@ -129,8 +173,26 @@ bool StatisticsHandler::handleGet(CivetServer* Server, struct mg_connection* Con
             statistics.push_back(stat); 
         }
 
+        auto messageHandlers = nlohmann::json::array();
+        for (auto& Stat : MessageHandlers)
+        {
+            if (Stat.CallCount == 0)
+            {
+                continue;
+            }
+
+            auto handler = nlohmann::json::object();
+            handler["messageType"] = Stat.TypeName;
+            handler["managerName"] = Stat.ManagerName;
+            handler["callCount"] = Stat.CallCount;
+            handler["averageTimeUs"] = static_cast<size_t>((Stat.TotalTime / Stat.CallCount) * 1000000.0);
+            handler["peakTimeUs"] = static_cast<size_t>(Stat.PeakTime * 1000000.0);
+            messageHandlers.push_back(handler);
+        }
+
         json["activePlayerSamples"] = activePlayerSamples;
         json["populatedAreas"] = populatedAreas;
+        json["messageHandlers"] = messageHandlers;
         json["statistics"] = statistics;
     }
 
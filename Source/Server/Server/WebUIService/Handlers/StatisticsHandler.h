@@ -11,6 +11,7 @@
 
 #include "Server/WebUIService/Handlers/WebUIHandler.h"
 #include "Server/GameService/PlayerState.h"
+#include "Server/GameService/GameMessageDispatcher.h"
 
 #include <mutex>
 
@@ -44,6 +45,7 @@ protected:
 
 	std::unordered_map<std::string, size_t> Statistics;
 	std::map<OnlineAreaId, size_t> PopulatedAreas; 
+	std::vector<GameMessageDispatcher::HandlerStatistics> MessageHandlers;
 
 	size_t UniquePlayerCount = 0;
 
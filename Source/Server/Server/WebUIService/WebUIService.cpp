@@ -100,6 +100,13 @@ void WebUIService::Poll()
     GatherData();
 }
 
+double WebUIService::GetNextPollTime()
+{
+    // Nothing here is time critical, requests are served on the web servers
+    // own threads, we just need to refresh the data they read periodically.
+    return GetSeconds() + BuildConfig::SERVICE_IDLE_POLL_INTERVAL;
+}
+
 std::string WebUIService::GetName()
 {
     return "WebUI";
@@ -118,13 +125,17 @@ std::string WebUIService::AddAuthToken()
 
     std::vector<uint8_t> Bytes;
     Bytes.resize(64);
-    FillRandomBytes(Bytes.data(), (int)Bytes.size());
+    FillRandomBytes(Bytes.data(), Bytes.size());
 
     AuthToken NewToken;
     NewToken.Token = BytesToHex(Bytes);
     NewToken.ExpireTime = GetSeconds() + BuildConfig::WEBUI_AUTH_TIMEOUT;
     AuthTokens[NewToken.Token] = NewToken;
 
+    TokenTimers.Schedule(NewToken.ExpireTime, [this, Token = NewToken.Token]() {
+        AuthTokens.erase(Token);
+    });
+
     return NewToken.Token;
 }
 
@@ -145,18 +156,7 @@ void WebUIService::ClearExpiredTokens()
 {
     std::scoped_lock lock(StateMutex);
 
-    double Time = GetSeconds();
-    for (auto iter = AuthTokens.begin(); iter != AuthTokens.end(); /* empty */)
-    {
-        if (Time > iter->second.ExpireTime)
-        {
-            iter = AuthTokens.erase(iter);
-        }
-        else
-        {
-            iter++;
-        }
-    }
+    TokenTimers.Advance(GetSeconds());
 }
 
 void WebUIService::GatherData()
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Server/Service.h"
+#include "Core/Utils/TimerWheel.h"
 
 #include "ThirdParty/civetweb/include/civetweb.h"
 #include "ThirdParty/civetweb/include/CivetServer.h"
@@ -35,6 +36,7 @@ public:
     virtual bool Init() override;
     virtual bool Term() override;
     virtual void Poll() override;
+    virtual double GetNextPollTime() override;
 
     virtual std::string GetName() override;
 
@@ -65,4 +67,7 @@ private:
     std::recursive_mutex StateMutex;
     std::unordered_map<std::string, AuthToken> AuthTokens;
 
+    // Expiry of AuthTokens, guarded by StateMutex.
+    TimerWheel TokenTimers;
+
 };
\ No newline at end of file
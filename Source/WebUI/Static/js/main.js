@@ -409,6 +409,26 @@ function refreshStatisticsTab()
         }
 
         populatedAreasTable.innerHTML = newHtml;
+
+        // Update message handler list.
+        var messageHandlersTable = document.querySelector("#message-handlers-table-body");   
+        newHtml = "";
+
+        for (var i = 0; i < data.messageHandlers.length; i++) 
+        {
+            var stat = data.messageHandlers[i];
+            newHtml += `        
+                <tr>
+                    <td class="mdl-data-table__cell--non-numeric">${stat["messageType"]}</td>
+                    <td class="mdl-data-table__cell--non-numeric">${stat["managerName"]}</td>
+                    <td>${stat["callCount"]}</td>
+                    <td>${stat["averageTimeUs"]}</td>
+                    <td>${stat["peakTimeUs"]}</td>
+                </tr>
+            `;
+        }
+
+        messageHandlersTable.innerHTML = newHtml;
     })
     .catch(function (error) 
     {
@@ -455,6 +475,7 @@ function refreshPlayersTab()
                     <td>${player["location"]}</td>
                     <td>${player["playTime"]}</td>
                     <td>${player["connectionTime"]}</td>
+                    <td>${player["ping"]} ms (RTO ${player["retransmitTimeout"]} ms)</td>
                     <td>
                         <button class="mdl-button mdl-js-button mdl-button--raised mdl-button--colored" onclick="disconnectUser(${player["playerId"]})">
                             Disconnect